@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "fmt/core.h"
+#include "maze.h"
+
+namespace {
+
+/**
+ * A search algorithm of the maze that can be benchmarked.
+ */
+struct Algorithm {
+    const char* name;
+    SearchTrace (*run)(Maze& maze, unsigned threads);
+};
+
+/**
+ * Follows a distance field to the end from the start. The field is recomputed for every query, so
+ * this measures one multi-source BFS plus the walk, not the agents that share a field.
+ */
+SearchTrace follow_distance_field(Maze& maze) {
+    auto const& field = maze.distance_field(false);
+
+    SearchTrace trace;
+    for (auto const idx : field.path(maze.get_grid(), maze.get_start().id))
+        trace.add_path(idx);
+    trace.stats().expanded = field.reached();
+    return trace;
+}
+
+const std::array<Algorithm, 16> algorithms{{
+    {"bfs", [](Maze& m, unsigned) { return m.bfs(); }},
+    {"parallel_bfs", [](Maze& m, unsigned threads) { return m.parallel_bfs(threads); }},
+    {"wavefront_bfs", [](Maze& m, unsigned) { return m.wavefront_bfs(); }},
+    {"dfs", [](Maze& m, unsigned) { return m.dfs(); }},
+    {"dijkstra", [](Maze& m, unsigned) { return m.dijkstra(); }},
+    {"dijkstra_buckets", [](Maze& m, unsigned) { return m.dijkstra(PriorityQueue::Buckets); }},
+    {"a_star_manhattan", [](Maze& m, unsigned) { return m.a_star(Heuristics::Manhattan); }},
+    {"a_star_euclidean", [](Maze& m, unsigned) { return m.a_star(Heuristics::Euclidean); }},
+    {"a_star_buckets", [](Maze& m, unsigned) { return m.a_star(Heuristics::Manhattan, PriorityQueue::Buckets); }},
+    {"jps", [](Maze& m, unsigned) { return m.jps(); }},
+    {"jps_plus", [](Maze& m, unsigned) { return m.jps_plus(); }},
+    {"bidirectional_bfs", [](Maze& m, unsigned) { return m.bidirectional_bfs(); }},
+    {"bidirectional_a_star", [](Maze& m, unsigned) { return m.bidirectional_a_star(); }},
+    {"hpa_star", [](Maze& m, unsigned) { return m.hpa_star(); }},
+    // Every query has a new end, so D* Lite plans from scratch and nothing is repaired.
+    {"d_star_lite", [](Maze& m, unsigned) { return m.d_star_lite(); }},
+    {"distance_field", [](Maze& m, unsigned) { return follow_distance_field(m); }},
+}};
+
+struct Options {
+    std::vector<int> sizes{64, 128, 256, 512, 1024, 2048, 4096, 8192};
+    std::vector<int> probs{3, 7};
+    std::vector<int> seeds{1, 2};
+    int queries{5};
+    unsigned threads{0};  /// Threads of the parallel algorithms, 0 for one per hardware thread.
+    std::vector<std::string> algorithms;  /// Empty means all algorithms.
+    std::string format{"csv"};
+    std::string output;  /// Empty means stdout.
+};
+
+/**
+ * Result of all queries of one algorithm on one maze. It is copied bytewise from the process that
+ * measured it, so it holds no pointers other than the name literal.
+ */
+struct Result {
+    const char* algorithm;
+    int size;
+    int prob;
+    int seed;
+    int queries;
+    double ns_per_query;
+    double expanded_per_query;
+    double expanded_per_s;
+    double path_length;
+    std::size_t peak_frontier;
+    std::size_t trace_bytes;
+    long run_rss_kb;  /// Peak resident memory added by the run, see isolated.
+};
+
+/**
+ * Returns the peak resident set size of the process in KiB, or 0 if it is unknown.
+ */
+long peak_rss_kb() {
+#if defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+#elif defined(__unix__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Parses a whole string as int.
+ *
+ * @throws std::invalid_argument or std::out_of_range if it is not a number or has trailing characters.
+ */
+int parse_int(const std::string& s) {
+    std::size_t used = 0;
+    auto const value = std::stoi(s, &used);
+    if (used != s.size())
+        throw std::invalid_argument("Trailing characters in " + s);
+    return value;
+}
+
+bool all_positive(const std::vector<int>& values) {
+    return std::all_of(values.begin(), values.end(), [](int v) { return v > 0; });
+}
+
+std::vector<int> parse_list(const std::string& s) {
+    std::vector<int> res;
+    std::size_t pos = 0;
+    while (pos < s.size()) {
+        auto const next = s.find(',', pos);
+        auto const end = next == std::string::npos ? s.size() : next;
+        res.push_back(parse_int(s.substr(pos, end - pos)));
+        pos = end + 1;
+    }
+    return res;
+}
+
+std::vector<std::string> parse_names(const std::string& s) {
+    std::vector<std::string> res;
+    std::size_t pos = 0;
+    while (pos < s.size()) {
+        auto const next = s.find(',', pos);
+        auto const end = next == std::string::npos ? s.size() : next;
+        res.push_back(s.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    return res;
+}
+
+void print_usage() {
+    fmt::print(
+        "Usage: maze_bench [options]\n"
+        "  --sizes=N,...       Width and height of the mazes (default 64,128,...,8192)\n"
+        "  --probs=N,...       Obstacle parameter, a cell is impassable with probability 1/(N+1) (default 3,7)\n"
+        "  --seeds=N,...       Seeds of the mazes and queries (default 1,2)\n"
+        "  --queries=N         Start/end pairs per maze (default 5)\n"
+        "  --threads=N         Threads of the parallel algorithms (default one per hardware thread)\n"
+        "  --algorithms=A,...  Algorithms to run (default all)\n"
+        "  --format=csv|json   Output format (default csv)\n"
+        "  --output=PATH       Output file (default stdout)\n"
+        "Algorithms:");
+    for (auto const& a : algorithms)
+        fmt::print(" {}", a.name);
+    fmt::print(" batch_a_star\n");
+}
+
+/**
+ * Parses the command line. Returns false if an option is unknown or its value is malformed or
+ * not positive, then the usage is printed.
+ */
+bool parse_options(int argc, char** argv, Options& options) {
+    try {
+        for (auto i = 1; i < argc; ++i) {
+            std::string const arg = argv[i];
+            auto const eq = arg.find('=');
+            auto const key = arg.substr(0, eq);
+            auto const value = eq == std::string::npos ? std::string{} : arg.substr(eq + 1);
+
+            if (key == "--sizes")
+                options.sizes = parse_list(value);
+            else if (key == "--probs")
+                options.probs = parse_list(value);
+            else if (key == "--seeds")
+                options.seeds = parse_list(value);
+            else if (key == "--queries")
+                options.queries = parse_int(value);
+            else if (key == "--threads" && parse_int(value) > 0)
+                options.threads = static_cast<unsigned>(parse_int(value));
+            else if (key == "--algorithms")
+                options.algorithms = parse_names(value);
+            else if (key == "--format" && (value == "csv" || value == "json"))
+                options.format = value;
+            else if (key == "--output")
+                options.output = value;
+            else
+                return false;
+        }
+    } catch (const std::logic_error&) {
+        // Thrown by std::stoi and parse_int for values that are not numbers.
+        return false;
+    }
+    return options.queries > 0 && all_positive(options.sizes) && all_positive(options.probs);
+}
+
+bool selected(const Options& options, const char* name) {
+    if (options.algorithms.empty())
+        return true;
+    for (auto const& a : options.algorithms) {
+        if (a == name)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Runs one algorithm for every query on the maze. The first query is run once untimed, so lazily
+ * built data like the JPS+ table, the HPA* graph and the search workspace are not part of the measurement.
+ */
+Result run(Maze& maze, const Algorithm& algorithm, const std::vector<std::array<int, 4>>& queries,
+           unsigned threads) {
+    using clock = std::chrono::steady_clock;
+
+    maze.set_start(queries[0][0], queries[0][1]);
+    maze.set_end(queries[0][2], queries[0][3]);
+    algorithm.run(maze, threads);
+
+    std::chrono::nanoseconds elapsed{0};
+    std::size_t expanded = 0;
+    std::size_t path = 0;
+    std::size_t peak_frontier = 0;
+    std::size_t trace_bytes = 0;
+
+    for (auto const& q : queries) {
+        maze.set_start(q[0], q[1]);
+        maze.set_end(q[2], q[3]);
+
+        auto const t1 = clock::now();
+        auto const trace = algorithm.run(maze, threads);
+        auto const t2 = clock::now();
+
+        elapsed += t2 - t1;
+        expanded += trace.stats().expanded;
+        path += trace.path_size();
+        peak_frontier = std::max(peak_frontier, trace.stats().peak_frontier);
+        trace_bytes = std::max(trace_bytes, trace.memory_bytes());
+    }
+
+    auto const n = static_cast<double>(queries.size());
+    auto const ns = static_cast<double>(elapsed.count());
+
+    return Result{
+        algorithm.name,
+        maze.width(),
+        0,
+        0,
+        static_cast<int>(queries.size()),
+        ns / n,
+        static_cast<double>(expanded) / n,
+        ns > 0 ? static_cast<double>(expanded) / ns * 1e9 : 0.0,
+        static_cast<double>(path) / n,
+        peak_frontier,
+        trace_bytes,
+        0,
+    };
+}
+
+/**
+ * Runs all queries as one batch. The batch is run once untimed to start the threads and size the
+ * workspaces. Expanded nodes are not counted by batches.
+ */
+Result run_batch(Maze& maze, const std::vector<std::array<int, 4>>& queries, unsigned threads) {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<Query> batch;
+    for (auto const& q : queries) {
+        auto const& grid = maze.get_grid();
+        batch.push_back({grid.index(q[0], q[1]), grid.index(q[2], q[3])});
+    }
+    maze.batch_a_star(batch, threads);
+
+    auto const t1 = clock::now();
+    auto const paths = maze.batch_a_star(batch, threads);
+    auto const t2 = clock::now();
+
+    std::size_t path = 0;
+    for (std::size_t i = 0; i < paths.size(); ++i)
+        path += paths.path_size(i);
+
+    auto const n = static_cast<double>(queries.size());
+    auto const ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+
+    return Result{
+        "batch_a_star",
+        maze.width(),
+        0,
+        0,
+        static_cast<int>(queries.size()),
+        ns / n,
+        0.0,
+        0.0,
+        static_cast<double>(path) / n,
+        0,
+        paths.memory_bytes(),
+        0,
+    };
+}
+
+/**
+ * Runs a measurement in a child process, so that its peak memory is not mixed up with the runs
+ * before it. ru_maxrss of this process only ever grows. The child starts with the resident memory
+ * of this process, mostly the maze, and reports the peak it added on top of that. Searches never
+ * run in this process, so no worker threads exist when it forks. Without fork, the measurement
+ * runs in this process and reports no memory.
+ */
+template <typename F>
+Result isolated(F&& measure) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fds[2];
+    if (::pipe(fds) != 0)
+        throw std::runtime_error("Failed to create a pipe");
+    auto const pid = ::fork();
+    if (pid < 0)
+        throw std::runtime_error("Failed to fork");
+
+    if (pid == 0) {
+        ::close(fds[0]);
+        auto ok = false;
+        try {
+            auto const baseline = peak_rss_kb();
+            auto result = measure();
+            result.run_rss_kb = peak_rss_kb() - baseline;
+            ok = ::write(fds[1], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+        } catch (...) {
+        }
+        ::_exit(ok ? 0 : 1);
+    }
+
+    ::close(fds[1]);
+    Result result{};
+    auto const n = ::read(fds[0], &result, sizeof(result));
+    ::close(fds[0]);
+    auto status = 0;
+    ::waitpid(pid, &status, 0);
+    if (n != static_cast<ssize_t>(sizeof(result)) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        throw std::runtime_error("The benchmark process failed");
+    return result;
+#else
+    return measure();
+#endif
+}
+
+void write_header(std::FILE* out, const Options& options) {
+    if (options.format == "json")
+        fmt::print(out, "[\n");
+    else
+        fmt::print(out, "algorithm,size,prob,seed,queries,ns_per_query,expanded_per_query,expanded_per_s,path_length,peak_frontier,trace_bytes,run_rss_kb\n");
+}
+
+void write_result(std::FILE* out, const Options& options, const Result& r, bool first) {
+    if (options.format == "json") {
+        fmt::print(out,
+                   "{}  {{\"algorithm\": \"{}\", \"size\": {}, \"prob\": {}, \"seed\": {}, \"queries\": {}, "
+                   "\"ns_per_query\": {:.0f}, \"expanded_per_query\": {:.1f}, \"expanded_per_s\": {:.0f}, "
+                   "\"path_length\": {:.1f}, \"peak_frontier\": {}, \"trace_bytes\": {}, \"run_rss_kb\": {}}}",
+                   first ? "" : ",\n", r.algorithm, r.size, r.prob, r.seed, r.queries, r.ns_per_query,
+                   r.expanded_per_query, r.expanded_per_s, r.path_length, r.peak_frontier, r.trace_bytes,
+                   r.run_rss_kb);
+    } else {
+        fmt::print(out, "{},{},{},{},{},{:.0f},{:.1f},{:.0f},{:.1f},{},{},{}\n", r.algorithm, r.size, r.prob,
+                   r.seed, r.queries, r.ns_per_query, r.expanded_per_query, r.expanded_per_s, r.path_length,
+                   r.peak_frontier, r.trace_bytes, r.run_rss_kb);
+    }
+    std::fflush(out);
+}
+
+void write_footer(std::FILE* out, const Options& options) {
+    if (options.format == "json")
+        fmt::print(out, "\n]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    auto* out = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+    if (out == nullptr) {
+        fmt::print(stderr, "Failed to open {}\n", options.output);
+        return 1;
+    }
+
+    write_header(out, options);
+    auto first = true;
+
+    for (auto const size : options.sizes) {
+        for (auto const prob : options.probs) {
+            for (auto const seed : options.seeds) {
+                Maze maze(true, size, size, prob, static_cast<std::uint32_t>(seed));
+
+                // Random start/end pairs. They are made passable up front, so every algorithm
+                // runs on the same maze.
+                std::mt19937 rng(static_cast<std::uint32_t>(seed));
+                std::uniform_int_distribution<int> coord(0, size - 1);
+                std::vector<std::array<int, 4>> queries(options.queries);
+                for (auto& q : queries) {
+                    q = {coord(rng), coord(rng), coord(rng), coord(rng)};
+                    maze.set_start(q[0], q[1]);
+                    maze.set_end(q[2], q[3]);
+                }
+
+                for (auto const& algorithm : algorithms) {
+                    if (!selected(options, algorithm.name))
+                        continue;
+
+                    auto result = isolated([&] { return run(maze, algorithm, queries, options.threads); });
+                    result.prob = prob;
+                    result.seed = seed;
+                    write_result(out, options, result, first);
+                    first = false;
+                }
+
+                if (selected(options, "batch_a_star")) {
+                    auto result = isolated([&] { return run_batch(maze, queries, options.threads); });
+                    result.prob = prob;
+                    result.seed = seed;
+                    write_result(out, options, result, first);
+                    first = false;
+                }
+            }
+        }
+    }
+
+    write_footer(out, options);
+    if (out != stdout)
+        std::fclose(out);
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#ifndef MAZE_BATCH_SEARCH_H
+#define MAZE_BATCH_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "grid.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+/**
+ * A routing query between two cells of a maze.
+ */
+struct Query {
+    int start{};  /// Cell index of the starting point.
+    int end{};    /// Cell index of the end point.
+};
+
+/**
+ * Shortest paths of a batch of queries, in the order of the queries.
+ * The paths are stored back to back as packed 32-bit cell indices in one buffer.
+ */
+class PathBatch {
+   private:
+    std::vector<std::uint32_t> cells;   /// Cells of every path, from start to end.
+    std::vector<std::size_t> offsets;   /// Path i is cells[offsets[i], offsets[i + 1]).
+
+    friend class BatchSearch;
+
+   public:
+    std::size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    /**
+     * Returns the number of cells of path i, 0 if the end of the query is not reachable.
+     */
+    std::size_t path_size(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+    /**
+     * Returns the cost of path i, -1 if the end of the query is not reachable.
+     */
+    int cost(std::size_t i) const { return static_cast<int>(path_size(i)) - 1; }
+
+    /**
+     * Returns cell j of path i.
+     */
+    int path(std::size_t i, std::size_t j) const { return static_cast<int>(cells[offsets[i] + j]); }
+
+    /**
+     * Returns the number of bytes used by the buffers.
+     */
+    std::size_t memory_bytes() const {
+        return cells.capacity() * sizeof(std::uint32_t) + offsets.capacity() * sizeof(std::size_t);
+    }
+};
+
+/**
+ * Answers many queries on one grid concurrently with A*.
+ * The grid is only read, every thread of the pool searches with its own workspace. The queries
+ * are handed out in chunks of consecutive queries, whose paths are collected per chunk, so the
+ * result is in input order without sorting.
+ * The buffers are kept between batches, so repeated batches on one maze do not allocate.
+ */
+class BatchSearch {
+   private:
+    std::vector<SearchWorkspace> workspaces;            /// One per thread of the pool.
+    std::vector<std::vector<std::uint32_t>> chunks;     /// Cells of the paths found by every chunk.
+    std::vector<std::size_t> sizes;                     /// Number of path cells of every query.
+
+   public:
+    /**
+     * Finds the shortest path of every query. Queries whose start or end is impassable or
+     * outside the grid get an empty path.
+     *
+     * @param grid The grid, which must not change during the call.
+     * @param pool Threads that run the searches.
+     * @param queries Queries with cell indices of the grid.
+     * @return The paths in the order of the queries.
+     */
+    PathBatch run(const Grid& grid, ThreadPool& pool, const std::vector<Query>& queries);
+};
+
+#endif  // MAZE_BATCH_SEARCH_H
@@ -0,0 +1,62 @@
+#ifndef MAZE_BUCKET_QUEUE_H
+#define MAZE_BUCKET_QUEUE_H
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Monotone priority queue for small integer priorities, as used by Dial's algorithm.
+ * The buckets form a ring, so priorities in [min, min + span] can be queued at the same time.
+ * Push and pop are O(1) amortized. Within a bucket the last pushed cell is popped first.
+ * Resetting keeps the bucket buffers, so a reused queue does not allocate.
+ */
+class BucketQueue {
+   private:
+    std::vector<std::vector<int>> buckets;
+    std::size_t mask{};   /// Number of buckets - 1, the number of buckets is a power of two.
+    int cursor{};         /// Priority of the bucket that is popped next.
+    std::size_t count{};  /// Number of queued cells.
+    bool started{};       /// False until the first push after a reset.
+
+   public:
+    /**
+     * Empties the queue and sizes the ring.
+     *
+     * @param span Largest difference between a pushed priority and the smallest queued one.
+     */
+    void reset(int span);
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    /**
+     * Queues a cell. Priorities below the current minimum are queued with the current minimum,
+     * which only happens with inconsistent heuristics.
+     *
+     * @param priority Priority of the cell, at most span larger than the current minimum.
+     * @param idx Cell index.
+     */
+    void push(int priority, int idx) {
+        // The minimum never decreases, even when the queue runs empty between a pop and the next pushes.
+        if (!started) {
+            cursor = priority;
+            started = true;
+        } else if (priority < cursor)
+            priority = cursor;
+        assert(static_cast<std::size_t>(priority - cursor) <= mask);
+
+        buckets[static_cast<std::size_t>(priority) & mask].push_back(idx);
+        ++count;
+    }
+
+    /**
+     * Removes a cell with the smallest priority.
+     *
+     * @return The pair <priority, cell index>.
+     */
+    std::pair<int, int> pop();
+};
+
+#endif  // MAZE_BUCKET_QUEUE_H
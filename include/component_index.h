@@ -0,0 +1,53 @@
+#ifndef MAZE_COMPONENT_INDEX_H
+#define MAZE_COMPONENT_INDEX_H
+
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Connected components of the passable cells, kept in a union-find forest, so reachability
+ * queries cost nearly O(1).
+ *
+ * A cell that becomes passable is united with its neighbors in place. A cell that becomes
+ * impassable can split a component, which union-find cannot undo. If the passable cells around
+ * it are still connected to each other, the components stay the same and nothing is done,
+ * otherwise the index is rebuilt lazily on the next query.
+ */
+class ComponentIndex {
+   private:
+    std::vector<int> parent;  /// Parent of every cell in the forest, roots are their own parent.
+    std::vector<int> size;    /// Number of cells in the tree of a root.
+    bool dirty{true};         /// True if the index has to be rebuilt before the next query.
+
+    int find(int idx);
+    void unite(int a, int b);
+
+    /**
+     * Builds the index from scratch.
+     */
+    void build(const Grid& grid);
+
+   public:
+    /**
+     * Records that a cell became passable.
+     */
+    void open(const Grid& grid, int idx);
+
+    /**
+     * Records that a cell became impassable.
+     */
+    void close(const Grid& grid, int idx);
+
+    /**
+     * Marks the whole index as out of date, for example after every cell changed.
+     */
+    void invalidate() { dirty = true; }
+
+    /**
+     * Returns true if both cells are passable and b can be reached from a.
+     */
+    bool connected(const Grid& grid, int a, int b);
+};
+
+#endif  // MAZE_COMPONENT_INDEX_H
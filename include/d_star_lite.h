@@ -0,0 +1,71 @@
+#ifndef MAZE_D_STAR_LITE_H
+#define MAZE_D_STAR_LITE_H
+
+#include <utility>
+#include <vector>
+
+#include "grid.h"
+#include "indexed_heap.h"
+#include "search_trace.h"
+
+/**
+ * Incremental shortest path planner (D* Lite) on a grid whose cells change between plans.
+ *
+ * The planner searches backwards from the goal and keeps, for every cell, its distance to the
+ * goal g and the one-step lookahead rhs. After cells changed, only the cells whose distance is
+ * affected by the change are expanded again. The start may move between plans, the goal may not:
+ * a new goal starts over from scratch.
+ *
+ * See also Koenig and Likhachev, "D* Lite".
+ */
+class DStarLite {
+   private:
+    std::vector<int> g;        /// Distance to the goal.
+    std::vector<int> rhs;      /// Distance to the goal via the best neighbor.
+    IndexedHeap open;          /// Cells where g != rhs, keyed by <k1, k2>.
+    std::vector<int> changed;  /// Cells whose passability changed since the last plan.
+
+    int cells{};        /// Number of cells of the grid of the current state, 0 if there is none.
+    int goal{-1};       /// Goal of the current state.
+    int start{-1};      /// Start of the last plan.
+    int km{};           /// Sum of the heuristic distances the start moved since the state was created.
+
+    /**
+     * Returns the key <k1, k2> of a cell, by which the open cells are expanded.
+     */
+    std::pair<int, int> key(const Grid& grid, int idx) const;
+
+    /**
+     * Recomputes rhs of a cell and queues it if it became inconsistent.
+     */
+    void update_vertex(const Grid& grid, int idx, SearchStats& stats);
+
+    /**
+     * Expands inconsistent cells until the distance of the start is known.
+     */
+    void compute_shortest_path(const Grid& grid, SearchTrace& trace);
+
+   public:
+    /**
+     * Records that the passability of a cell changed. The change is repaired by the next plan.
+     *
+     * @param idx Cell index.
+     */
+    void invalidate(int idx);
+
+    /**
+     * Drops the state, the next plan starts over from scratch.
+     */
+    void reset();
+
+    /**
+     * Plans a shortest path from start to goal, repairing the state of the previous plan.
+     *
+     * @param trace Receives every cell expanded by this plan and the shortest path, which is
+     *              empty if the goal is not reachable.
+     * @return The cost of the path, -1 if the goal is not reachable.
+     */
+    int plan(const Grid& grid, int start, int goal, SearchTrace& trace);
+};
+
+#endif  // MAZE_D_STAR_LITE_H
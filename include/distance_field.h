@@ -0,0 +1,92 @@
+#ifndef MAZE_DISTANCE_FIELD_H
+#define MAZE_DISTANCE_FIELD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Distance of every cell of a grid to the nearest of a set of goals, computed by one breadth first
+ * search from all goals at once. Many agents heading for the same goals then follow the field
+ * instead of searching one by one: every step goes to a neighbor one closer to a goal, so a path
+ * costs its length.
+ *
+ * Optionally the field also keeps a direction per cell, the neighbor to step to, which saves
+ * looking at the neighbors on every step.
+ *
+ * The buffers are kept between computations, so recomputing the field of one maze does not allocate.
+ */
+class DistanceField {
+   public:
+    static constexpr int unreachable = -1;            /// Distance of impassable cells and cells without a path to a goal.
+    static constexpr std::uint8_t no_direction = 0xFF;  /// Direction of goals and unreachable cells.
+
+   private:
+    int w{};
+    int h{};
+    std::vector<int> distances;           /// Distance per cell index.
+    std::vector<std::uint8_t> directions;  /// Neighbor per cell index, empty if not computed.
+    std::vector<int> queue;               /// Frontier of the search, reused between computations.
+    int farthest{unreachable};            /// Largest distance of a reachable cell.
+    std::size_t reached_cells{};          /// Number of cells with a distance.
+
+   public:
+    /**
+     * Computes the field of a grid. Impassable goals and goals outside the grid are ignored.
+     *
+     * @param goals Cell indices of the goals.
+     * @param with_directions True to keep a direction per cell.
+     */
+    void compute(const Grid& grid, const std::vector<int>& goals, bool with_directions = true);
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    /**
+     * Returns the distance of a cell to the nearest goal, or unreachable.
+     */
+    int distance(int idx) const { return distances[static_cast<std::size_t>(idx)]; }
+
+    /**
+     * Returns the distances of every cell by cell index.
+     */
+    const std::vector<int>& data() const { return distances; }
+
+    /**
+     * Returns the largest distance of a reachable cell, or unreachable if no goal is passable.
+     */
+    int max_distance() const { return farthest; }
+
+    /**
+     * Returns the number of cells with a path to a goal, including the goals.
+     */
+    std::size_t reached() const { return reached_cells; }
+
+    bool has_directions() const { return !directions.empty(); }
+
+    /**
+     * Returns the direction of a cell as an index into the neighbor order of Grid::for_each_neighbor,
+     * or no_direction. The field must have been computed with directions.
+     */
+    std::uint8_t direction(int idx) const { return directions[static_cast<std::size_t>(idx)]; }
+
+    /**
+     * Returns the neighbor one step closer to a goal, or -1 if the cell is a goal or unreachable.
+     * Without directions the first such neighbor in the order of Grid::for_each_neighbor is taken.
+     *
+     * @param grid The grid the field was computed for.
+     */
+    int next(const Grid& grid, int idx) const;
+
+    /**
+     * Follows the field from a cell to the nearest goal.
+     *
+     * @param grid The grid the field was computed for.
+     * @return The cells from idx to the goal, empty if idx is unreachable.
+     */
+    std::vector<int> path(const Grid& grid, int idx) const;
+};
+
+#endif  // MAZE_DISTANCE_FIELD_H
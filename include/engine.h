@@ -1,12 +1,20 @@
 #ifndef MAZE_ENGINE_H
 #define MAZE_ENGINE_H
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "SFML/Graphics.hpp"
 #include "maze.h"
+#include "search_worker.h"
+#include "stepped_search.h"
 
 const auto scale = 20;
 const auto border_size = 1;
-const auto top_margin = 50;
+const auto top_margin = 80;
+const auto cell_size = scale + border_size * 2;  /// Distance between the cells in pixels.
 
 const auto color_bg = sf::Color(45, 45, 45, 255);
 const auto color_rect = sf::Color(225, 225, 225, 255);
@@ -16,19 +24,132 @@ const auto color_start = sf::Color(160, 212, 104, 255);
 const auto color_end = sf::Color(72, 207, 173, 255);
 const auto color_start_end = sf::Color(252, 110, 81, 255);
 const auto color_visited = sf::Color(252, 110, 81, 255);
+const auto color_visited_backward = sf::Color(93, 156, 236, 255);
+const auto color_open = sf::Color(172, 146, 236, 255);
 const auto color_current = sf::Color::Red;
 const auto color_shortest_path = sf::Color(216, 51, 74, 255);
+const auto color_field_near = sf::Color(255, 206, 84, 255);
+const auto color_field_far = sf::Color(59, 76, 192, 255);
+
+/**
+ * How the cells are drawn.
+ */
+enum class RenderMode {
+    Auto,     /// Quads for mazes with up to max_quad_cells cells, a texture for larger ones.
+    Quads,    /// Four vertices per cell in a vertex buffer.
+    Texture,  /// One texel per cell in a texture, drawn as one scaled sprite.
+};
+
+const auto max_quad_cells = 1 << 18;
+
+const auto min_visible_cells = 4;  /// The camera zooms in until this many cells fill the view.
+const auto zoom_step = 1.25f;      /// Factor of one step of zoom.
+const auto pan_step = 0.02f;       /// Fraction of the view the camera moves per frame.
+
+/// Larger mazes animate more cells per frame, so a search over every cell takes about this many frames.
+const auto animation_frames = 3600;
+
+/// Time a stepped search may take per frame.
+const auto step_budget = std::chrono::milliseconds(8);
 
 class Engine {
    private:
+    /**
+     * How the animated search marked a cell.
+     */
+    enum class Mark : std::uint8_t { None, Open, Visited, VisitedBackward, Path };
+
     sf::RenderWindow window;
     sf::Font font;
-    std::vector<sf::Vertex> vertices;
+
+    RenderMode mode;  /// Quads or Texture, never Auto.
+
+    // The cells are built once, as quads or as texels. Every frame only the cells whose color
+    // changed are written and uploaded, so the cost of a frame depends on the number of changes
+    // and not on the size of the maze.
+    std::vector<sf::Vertex> vertices;  /// Four vertices per cell, in cell index order.
+    sf::VertexBuffer buffer{sf::Quads, sf::VertexBuffer::Dynamic};  /// Copy of vertices on the GPU.
+    bool use_buffer{false};            /// False if vertex buffers are not available, then vertices are drawn.
+
+    std::vector<sf::Uint8> pixels;  /// RGBA texel per cell, in cell index order, in both modes.
+    sf::Texture texture;            /// Copy of pixels on the GPU, in texture mode.
+    sf::Sprite sprite;              /// Draws the texture scaled to cell_size pixels per texel.
+    sf::Texture grid_tile;          /// One cell with its border, the rest transparent.
+    sf::Sprite grid_lines;          /// Repeats grid_tile over the maze.
+
+    /// Side of the square tiles whose changed texels are uploaded as one rectangle.
+    static constexpr int dirty_tile_size = 64;
+
+    /**
+     * Texels of a texture that changed since the last upload, kept as the bounding rectangle of
+     * the changes within each tile. Changes far apart upload a few small rectangles instead of
+     * the band of rows between them.
+     */
+    struct DirtyTiles {
+        /// Inclusive bounds of the changed texels of a tile, empty if right < left.
+        struct Bounds {
+            int left{0};
+            int top{0};
+            int right{-1};
+            int bottom{-1};
+        };
+
+        int w{};                           /// Width of the texture in texels.
+        int columns{};                     /// Tiles per row.
+        std::vector<Bounds> bounds;        /// Per tile in row-major order.
+        std::vector<int> tiles;            /// Tiles with changes, each once.
+        bool all{true};                    /// True if the whole texture has to be uploaded.
+        std::vector<sf::Uint8> staging;    /// Rows of a rectangle narrower than the texture, packed.
+
+        /**
+         * Sizes the tiles for a texture, which is uploaded in full next.
+         */
+        void reset(int width, int height);
+
+        /**
+         * Marks a texel as changed.
+         */
+        void add(int x, int y);
+
+        /**
+         * Uploads the changed rectangles, or the whole texture, from its RGBA texels.
+         */
+        void upload(sf::Texture& texture, const std::vector<sf::Uint8>& pixels);
+    };
+
+    DirtyTiles texture_changes;  /// Texels of texture that were not uploaded yet, in texture mode.
+
+    /**
+     * Cells aggregated 2x2 per texel from the level below, drawn instead of the cells once a pixel
+     * covers several cells.
+     */
+    struct Level {
+        int w;                            /// Width in texels.
+        int h;                            /// Height in texels.
+        std::vector<sf::Uint8> pixels;    /// RGBA per texel.
+        std::vector<std::uint8_t> ranks;  /// Per texel, the rank of its most important cell.
+        DirtyTiles changes;               /// Texels that were not uploaded yet.
+        sf::Texture texture;
+    };
+
+    std::vector<std::uint8_t> ranks;  /// Per cell, how important its color is when cells are aggregated.
+    std::vector<Level> levels;        /// levels[i] aggregates 2^(i+1) x 2^(i+1) cells per texel.
+    sf::Sprite level_sprite;          /// Draws the visible part of a level.
+
+    sf::View camera;  /// Part of the maze shown below the text, in the coordinates of the cell quads.
+
+    int steps_per_frame{1};            /// Cells the animation advances per frame.
+    std::vector<Mark> marks;           /// Per cell, how the animated search marked it.
+    std::vector<int> dirty;            /// Cells whose color may have changed since the last frame.
+    bool all_dirty{true};              /// True if every cell has to be recolored.
+    int current{-1};                   /// Cell drawn as the current node, -1 if none.
+
+    DistanceField field;     /// Distances to the end shown as heatmap.
+    bool field_dirty{true};  /// True if the maze changed since the field was computed.
 
     std::string algorithm;  /// The algorithm used to find the end.
 
-    std::deque<Node> visited;         /// Contains all nodes that need to be drawn as visited.
-    std::deque<Node> sp;              /// Contains nodes of the shortest path.
+    SearchTrace trace;                /// Visited cells and shortest path of the last search.
     unsigned long counter_visited{};  /// Index up until visited nodes are drawn.
     unsigned long counter_sp{};       /// Index up until sp nodes are drawn.
 
@@ -38,49 +159,179 @@ class Engine {
     int r;  /// True if the maze has random impassable nodes.
 
     Maze maze;
+    SearchWorker worker;  /// Runs the searches on maze, declared after it to stop first.
+    std::unique_ptr<SteppedSearch> stepper;  /// Search advanced frame by frame, if one runs.
     bool finish{false};  /// True if all visited nodes were drawn.
     bool go{false};      /// True if the search algorithm was chosen.
+    bool show_field{false};  /// True if the distance field to the end is drawn as a heatmap.
 
     /**
      * Handles keyboard input.
      * Following key presses are defined:
+     * BFS, DFS, Dijkstra and A* are advanced frame by frame, the other searches run on a worker
+     * thread. Return and N cancel a running search.
      * Return: Resets the state of the engine but keeps the same maze.
      * N: Resets the state of the engine and creates a new maze.
+     * M: Resets the state of the engine and generates a perfect maze with Eller's algorithm.
      * C: Clears the maze.
+     * F: Shows or hides the distance of every cell to the end as a heatmap.
      * Esc: Closes the window.
-     * Num1: Runs BFS.
+     * Num1: Runs BFS, with LShift the parallel BFS.
      * Num2: Runs DFS.
      * Num3: Runs Dijkstra.
      * Num4: Runs A* with Manhattan heuristics.
      * Num5: Runs A* with Euclidean heuristics.
-     * Num6: Runs Bidirectional search.
+     * Num6: Runs Bidirectional A*, with LShift Bidirectional BFS.
+     * Num7: Runs Jump Point Search.
+     * Num8: Runs JPS+.
+     * Num9: Runs HPA*.
+     * Num0: Runs D* Lite, which only repairs its last search after the maze changed.
      *
      */
     void handle_keyboard_input();
 
     /**
-     * Handles mouse input.
+     * Handles mouse input, ignored while a search runs.
      * Left click: Mark node as impassable.
      * Right click: Mark node as passable.
      *
      */
     void handle_mouse_input();
 
+    /**
+     * Moves the camera.
+     * Mouse wheel: Zooms in or out around the mouse.
+     * Add/Equal, Subtract/Hyphen: Zooms in or out around the center.
+     * H: Shows the whole maze.
+     * Arrow keys, held: Pans.
+     */
+    void handle_camera_input(const sf::Event& event);
+    void pan_camera();
+
+    /**
+     * Zooms the camera by a factor, keeping the point under a pixel of the window in place.
+     */
+    void zoom_camera(float factor, sf::Vector2i pixel);
+
+    /**
+     * Fits the camera to the whole maze.
+     */
+    void reset_camera();
+
+    /**
+     * Returns the cell under a pixel of the window, or -1.
+     */
+    int cell_at(sf::Vector2i pixel) const;
+
+    /**
+     * Returns the first and last visible column and row of cells, clamped to the maze.
+     */
+    sf::IntRect visible_cells() const;
+
+    /**
+     * Draws the visible cells, or the visible texels of a level when zoomed out.
+     */
+    void draw_cells();
+
+    /**
+     * Resets the state of the engine, cancelling the running search.
+     */
     void reset();
 
+    /**
+     * Starts a search on the worker thread. Its cells are animated as they arrive.
+     */
+    void start_search(SearchWorker::Search search);
+
+    /**
+     * Appends the cells the worker visited since the last frame to the trace, and the path and
+     * statistics once the search finished.
+     */
+    void collect_search();
+
+    /**
+     * Starts a search that is advanced by the animation, showing its open and closed nodes.
+     */
+    void start_stepped_search(SteppedSearch::Algorithm search, Heuristics heuristic = Heuristics::Manhattan);
+
+    /**
+     * Runs the stepped search for one frame, by steps_per_frame steps within step_budget, and marks
+     * the nodes it opened and closed.
+     */
+    void advance_search();
+
+    /**
+     * Marks a cell to be recolored in the next frame.
+     */
+    void mark_dirty(int idx) { dirty.push_back(idx); }
+
+    /**
+     * Marks every cell to be recolored and the distance field to be recomputed, after the maze changed
+     * as a whole.
+     */
+    void invalidate();
+
+    /**
+     * Prints the statistics of every search of the maze to stdout.
+     */
+    void attach_observer();
+
     void draw_text();
-    void draw_background_vertex_array();
-    void draw_visited_vertex_array();
-    void draw_shorest_path_vertex_array();
-    void draw_current_node_vertex_array();
+
+    /**
+     * Advances the animation of the search by one visited cell, and by one path cell once every
+     * visited cell is shown. Stepped searches only animate their path here.
+     */
+    void advance_animation();
+
+    /**
+     * Returns the color of a cell: the current node, then the path and visited cells, then the
+     * start, end and impassable cells, then the heatmap.
+     */
+    sf::Color color_of(int idx) const;
+
+    /**
+     * Recolors the dirty cells and uploads them.
+     */
+    void update_cells();
+
+    /**
+     * Returns how important the color of a cell is when cells are aggregated: the current node,
+     * then start and end, then path, then visited cells. Cells of rank 0 are averaged.
+     */
+    std::uint8_t rank_of(int idx) const;
+
+    /**
+     * Recolors a cell in the vertices and pixels, without uploading it.
+     */
+    void paint(int idx);
+
+    /**
+     * Recomputes a texel of a level from its 2x2 texels of the level below.
+     */
+    void aggregate(std::size_t level, int x, int y);
+
+    /**
+     * Creates the levels of detail.
+     */
+    void build_levels();
+
+    /**
+     * Uploads the dirty cells, or every cell.
+     */
+    void upload(bool all);
+
+    /**
+     * Creates the quads of every cell, out of four vertices each.
+     */
+    void build_vertices();
+
     /**
-     * Creates a rectangle out of four vertices.
+     * Creates the texture with a texel per cell and the overlay of the grid lines.
      *
-     * @param x x-coordinate.
-     * @param y y-coordinate.
-     * @param color Color.
+     * @throws std::runtime_error if the texture cannot be created.
      */
-    void add_vertices(int x, int y, sf::Color color);
+    void build_texture();
 
     /// Functions below are deprecated because of performance issues.
     void draw_rectangle(int x, int y, const sf::Color color);
@@ -94,8 +345,10 @@ class Engine {
      * Construct a new Engine that is responsible for rendering the maze.
      *
      * @param random If true the maze will have random obstacles.
+     * @param render_mode How the cells are drawn.
      */
-    Engine(bool random = false, int width = WIDTH, int height = HEIGHT, int prob = 7);
+    Engine(bool random = false, int width = WIDTH, int height = HEIGHT, int prob = 7,
+           RenderMode render_mode = RenderMode::Auto);
 
     /**
      * Runs the engine.
@@ -0,0 +1,121 @@
+#ifndef MAZE_GENERATORS_H
+#define MAZE_GENERATORS_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Generators of perfect mazes, where there is exactly one path between any two rooms.
+ *
+ * The rooms lie on the cells with even coordinates. Two neighboring rooms are connected by opening
+ * the cell between them, every other cell stays impassable. A grid of width w and height h holds
+ * (w + 1) / 2 times (h + 1) / 2 rooms, with an even width or height the last column or row is a wall.
+ */
+namespace generators {
+
+enum class Algorithm {
+    RecursiveBacktracker,
+    Kruskal,
+    Prim,
+    Wilson,
+    Eller,
+};
+
+/**
+ * Depth-first search with an explicit stack, which carves long winding corridors.
+ */
+void recursive_backtracker(Grid& grid, std::uint32_t seed);
+
+/**
+ * Randomized Kruskal: opens the walls in random order if they separate two trees.
+ */
+void kruskal(Grid& grid, std::uint32_t seed);
+
+/**
+ * Randomized Prim: grows one tree by opening a random wall of its border, which gives many short
+ * dead ends.
+ */
+void prim(Grid& grid, std::uint32_t seed);
+
+/**
+ * Wilson's algorithm: joins the rooms with loop-erased random walks, so every spanning tree is
+ * equally likely.
+ */
+void wilson(Grid& grid, std::uint32_t seed);
+
+/**
+ * Eller's algorithm, see EllerStream.
+ */
+void eller(Grid& grid, std::uint32_t seed);
+
+/**
+ * Overwrites every cell of the grid with a perfect maze made by the given algorithm.
+ */
+void generate(Algorithm algorithm, Grid& grid, std::uint32_t seed);
+
+/**
+ * Eller's algorithm, which generates a perfect maze one row at a time with O(width) memory, so
+ * mazes far larger than the memory can be written straight to a file.
+ *
+ * Every room of a row belongs to a set of rooms that are connected through the rows above. Random
+ * neighbors of different sets are joined, then every set continues downwards through at least one
+ * room. The last row joins all remaining sets.
+ */
+class EllerStream {
+   private:
+    int w;
+    int h;
+    int rooms;  /// Number of rooms per row.
+    int y{};    /// Next row of the grid.
+
+    std::vector<int> set;            /// Set of every room of the current row.
+    std::vector<int> parent;         /// Union-find forest over the set labels, reset for every row.
+    std::vector<int> remaining;      /// Number of rooms of a set not yet visited by the vertical step.
+    std::vector<std::uint8_t> down;  /// 1 if a room of the set continues downwards.
+    std::vector<int> free;           /// Labels not used by the next row.
+
+    std::vector<std::uint64_t> row;      /// Row of the rooms and their horizontal passages.
+    std::vector<std::uint64_t> passage;  /// Row of the vertical passages below it.
+
+    std::mt19937_64 rng;
+    std::uint64_t bits{};  /// Random bits not used yet.
+    int bits_left{};
+
+    bool coin();
+    int find(int label);
+
+    /**
+     * Builds the next row of rooms and the passages below it.
+     */
+    void next_rooms();
+
+   public:
+    /**
+     * @param width Number of columns of the grid.
+     * @param height Number of rows of the grid.
+     * @param seed Seed of the random number generator.
+     */
+    EllerStream(int width, int height, std::uint32_t seed);
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    /**
+     * Returns true if every row was generated.
+     */
+    bool done() const { return y == h; }
+
+    /**
+     * Generates the next row of the grid.
+     *
+     * @return The row, packed like a row of Grid. It is valid until the next call.
+     */
+    const std::uint64_t* next();
+};
+
+}  // namespace generators
+
+#endif  // MAZE_GENERATORS_H
@@ -0,0 +1,172 @@
+#ifndef MAZE_GRID_H
+#define MAZE_GRID_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Diagonal movement is selected at compile time with the meson option 'diagonal_movement'.
+#ifdef MAZE_DIAGONAL_MOVEMENT
+constexpr bool diagonal_movement = true;
+#else
+constexpr bool diagonal_movement = false;
+#endif
+
+/// Maximum number of neighbors a cell can have.
+constexpr int max_neighbors = diagonal_movement ? 8 : 4;
+
+/**
+ * Fixed-capacity inline range of neighbor cell indices. Never allocates.
+ */
+struct Neighbors {
+    std::array<int, max_neighbors> cells{};
+    int count{};
+
+    void push_back(int idx) { cells[count++] = idx; }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int operator[](int i) const { return cells[i]; }
+    const int* begin() const { return cells.data(); }
+    const int* end() const { return cells.data() + count; }
+};
+
+/**
+ * Row-major passability plane with one bit per cell.
+ * Every row starts at a 64-bit word boundary, so a row can be processed word by word.
+ * Bits past the width of a row are always zero.
+ */
+class Grid {
+   private:
+    int w{};
+    int h{};
+    int stride{};  /// Number of 64-bit words per row.
+
+    std::vector<std::uint64_t> words;  /// The plane, unless it belongs to someone else.
+    std::shared_ptr<void> owner;       /// Keeps a plane that is not in words alive, for example a mapped file.
+    std::uint64_t* plane{};            /// First word of the plane.
+
+   public:
+    /**
+     * Creates a grid where every cell has the same passability.
+     *
+     * @param width Number of columns.
+     * @param height Number of rows.
+     * @param passable Initial value of every cell.
+     */
+    explicit Grid(int width = 0, int height = 0, bool passable = true);
+
+    /**
+     * Creates a grid over an existing plane without copying it, for example a memory-mapped file.
+     * The plane must have words_per_row() words per row and zero bits past the width.
+     *
+     * @param plane First word of the plane, which the grid modifies in place.
+     * @param owner Keeps the plane alive as long as the grid uses it.
+     */
+    static Grid view(int width, int height, std::uint64_t* plane, std::shared_ptr<void> owner);
+
+    /// Copies own their plane, moves keep the plane of the source.
+    Grid(const Grid& other);
+    Grid(Grid&& other) noexcept = default;
+    Grid& operator=(const Grid& other);
+    Grid& operator=(Grid&& other) noexcept = default;
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int size() const { return w * h; }
+    int words_per_row() const { return stride; }
+
+    int index(int x, int y) const { return y * w + x; }
+    bool in_bounds(int x, int y) const { return x >= 0 && x < w && y >= 0 && y < h; }
+    int x_of(int idx) const { return idx % w; }
+    int y_of(int idx) const { return idx / w; }
+
+    bool passable(int x, int y) const {
+        return (plane[static_cast<std::size_t>(y) * stride + (x >> 6)] >> (x & 63)) & 1u;
+    }
+
+    bool passable(int idx) const {
+        return passable(x_of(idx), y_of(idx));
+    }
+
+    /**
+     * Returns true if (x, y) lies inside the grid and is passable.
+     */
+    bool open(int x, int y) const { return in_bounds(x, y) && passable(x, y); }
+
+    void set_passable(int x, int y, bool passable);
+
+    /**
+     * Overwrites row y with words_per_row() words packed like row(y). Bits past the width are ignored.
+     */
+    void set_row(int y, const std::uint64_t* bits);
+
+    /**
+     * Calls f(neighbor_idx) for every passable neighbor of the cell idx.
+     * Neighbors are visited in the order left, right, up, down and, with diagonal movement,
+     * top left, top right, bottom left, bottom right.
+     *
+     * @param idx The cell whose neighbors we want to visit.
+     * @param f Visitor taking the neighbor's cell index.
+     */
+    template <typename F>
+    void for_each_neighbor(int idx, F&& f) const {
+        auto const x = x_of(idx);
+        auto const y = y_of(idx);
+
+        auto const left = x > 0;
+        auto const right = x < (w - 1);
+        auto const up = y > 0;
+        auto const down = y < (h - 1);
+
+        if (left && passable(x - 1, y))
+            f(idx - 1);
+        if (right && passable(x + 1, y))
+            f(idx + 1);
+        if (up && passable(x, y - 1))
+            f(idx - w);
+        if (down && passable(x, y + 1))
+            f(idx + w);
+
+        if constexpr (diagonal_movement) {
+            if (up && left && passable(x - 1, y - 1))
+                f(idx - w - 1);
+            if (up && right && passable(x + 1, y - 1))
+                f(idx - w + 1);
+            if (down && left && passable(x - 1, y + 1))
+                f(idx + w - 1);
+            if (down && right && passable(x + 1, y + 1))
+                f(idx + w + 1);
+        }
+    }
+
+    /**
+     * Returns the passable neighbors of the cell idx as an inline range.
+     *
+     * @param idx The cell whose neighbors we want to get.
+     */
+    Neighbors neighbors(int idx) const {
+        Neighbors res;
+        for_each_neighbor(idx, [&res](int n) { res.push_back(n); });
+        return res;
+    }
+
+    /**
+     * Sets every cell to the same passability.
+     */
+    void fill(bool passable);
+
+    /**
+     * Returns the first word of row y.
+     */
+    const std::uint64_t* row(int y) const { return plane + static_cast<std::size_t>(y) * stride; }
+
+    /**
+     * Returns the number of bytes used by the passability plane.
+     */
+    std::size_t memory_bytes() const { return static_cast<std::size_t>(stride) * h * sizeof(std::uint64_t); }
+};
+
+#endif  // MAZE_GRID_H
@@ -0,0 +1,72 @@
+#ifndef MAZE_GRID_METRICS_H
+#define MAZE_GRID_METRICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Heuristics of A*, the estimated distance of a cell to the end.
+ * A diagonal step costs 1 like a straight one, so with diagonal movement the Manhattan and the
+ * Euclidean distance would overestimate and both become the Chebyshev distance.
+ */
+enum class Heuristics {
+    Dijkstra,   /// No estimate, A* becomes Dijkstra's algorithm.
+    Manhattan,
+    Euclidean,
+};
+
+/**
+ * Returns -1, 0 or 1 by the sign of v.
+ */
+inline int sign(int v) {
+    return (v > 0) - (v < 0);
+}
+
+/// Length of the shortest path between two cells dx columns and dy rows apart on an empty grid,
+/// in int for Grid or in std::int64_t for TiledGrid.
+template <typename T>
+T grid_distance(T dx, T dy) {
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    return diagonal_movement ? std::max(dx, dy) : dx + dy;
+}
+
+/**
+ * Returns the estimate of a heuristic for two cells dx columns and dy rows apart, which never
+ * exceeds grid_distance.
+ */
+inline int heuristic_distance(Heuristics heuristic, int dx, int dy) {
+    if (diagonal_movement && heuristic != Heuristics::Dijkstra)
+        return grid_distance(dx, dy);
+
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    switch (heuristic) {
+        case Heuristics::Dijkstra:
+            return 0;
+        case Heuristics::Manhattan:
+            return dx + dy;
+        case Heuristics::Euclidean:
+            return static_cast<int>(std::sqrt(dx * dx + dy * dy));
+    }
+    return 0;
+}
+
+/**
+ * Returns the root of an element in a union-find forest, halving the path on the way.
+ *
+ * @param parent Parent of every element, roots are their own parent.
+ */
+inline int find_root(std::vector<int>& parent, int idx) {
+    while (parent[idx] != idx) {
+        parent[idx] = parent[parent[idx]];
+        idx = parent[idx];
+    }
+    return idx;
+}
+
+#endif  // MAZE_GRID_METRICS_H
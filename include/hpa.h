@@ -0,0 +1,100 @@
+#ifndef MAZE_HPA_H
+#define MAZE_HPA_H
+
+#include <utility>
+#include <vector>
+
+#include "grid.h"
+#include "search_trace.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+/**
+ * Hierarchical path-finding A* (HPA*) with one level of abstraction.
+ *
+ * The grid is split into square clusters. Where two clusters touch, every run of cells that can
+ * be crossed gets one or two transitions, a pair of neighboring cells on both sides. The cells of
+ * the transitions are the nodes of an abstract graph, connected by the transitions with cost 1 and
+ * inside a cluster by their precomputed distances. A query searches the abstract graph and refines
+ * every abstract edge to cells afterwards. The paths are near-optimal, because the abstract graph
+ * only passes the borders at the transitions.
+ *
+ * See also Botea et al., "Near Optimal Hierarchical Path-Finding".
+ */
+namespace hpa {
+
+/// Width and height of a cluster in cells.
+constexpr int cluster_size = 16;
+
+/**
+ * Abstract graph of a grid, which can be rebuilt cluster by cluster after the grid changed.
+ */
+class Graph {
+   private:
+    struct Cluster {
+        std::vector<int> nodes;                 /// Cells of the abstract nodes in this cluster.
+        std::vector<std::pair<int, int>> links; /// Pairs <node index, cell in the other cluster>.
+        std::vector<int> distances;             /// nodes x nodes distances inside the cluster, -1 if unreachable.
+        bool dirty{true};                       /// True if the cluster has to be rebuilt.
+    };
+
+    int w{};
+    int h{};
+    int columns{};  /// Number of clusters per row.
+    int rows{};     /// Number of clusters per column.
+
+    std::vector<Cluster> clusters;
+    std::vector<int> dirty;  /// Clusters to rebuild on the next update.
+
+    /**
+     * Computes the nodes, links and distances of cluster k from the grid.
+     */
+    void build_cluster(const Grid& grid, int k);
+
+    /**
+     * Marks the cluster with the given cluster coordinates for rebuilding, if it exists.
+     */
+    void mark(int cx, int cy);
+
+   public:
+    /**
+     * Builds the graph of every cluster.
+     */
+    void build(const Grid& grid, ThreadPool& pool);
+
+    /**
+     * Rebuilds the clusters that were affected by changed cells since the last build or update.
+     */
+    void update(const Grid& grid, ThreadPool& pool);
+
+    /**
+     * Records that the passability of (x, y) changed. Marks the cluster of the cell and, if the
+     * cell lies on the border of its cluster, the clusters behind that border.
+     */
+    void invalidate(int x, int y);
+
+    /**
+     * Returns the number of abstract nodes.
+     */
+    std::size_t size() const;
+
+    /**
+     * Returns the number of clusters that wait for a rebuild.
+     */
+    std::size_t dirty_size() const { return dirty.size(); }
+
+    /**
+     * Searches the abstract graph from start to end and refines the result to a path of cells.
+     * The graph must be up to date.
+     *
+     * @param workspace Workspace prepared for the grid.
+     * @param trace Receives every expanded abstract node and the refined path, which is empty if
+     *              the end is not reachable.
+     * @return The cost of the path, -1 if the end is not reachable.
+     */
+    int find_path(const Grid& grid, SearchWorkspace& workspace, int start, int end, SearchTrace& trace) const;
+};
+
+}  // namespace hpa
+
+#endif  // MAZE_HPA_H
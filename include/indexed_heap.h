@@ -0,0 +1,103 @@
+#ifndef MAZE_INDEXED_HEAP_H
+#define MAZE_INDEXED_HEAP_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Min-heap of cells with decrease-key, implemented as a 4-ary heap.
+ * The position of every cell in the heap is kept in a flat array, so a cell is queued at most once
+ * and its priority can be lowered in place. Memory is therefore bounded by the number of cells.
+ * Cells with the same priority are ordered by a second key, smaller first.
+ */
+class IndexedHeap {
+   private:
+    static constexpr std::size_t arity = 4;
+
+    struct Entry {
+        int priority;
+        int tie;  /// Second key, compared if the priorities are equal.
+        int idx;  /// Cell index.
+
+        bool operator<(const Entry& other) const {
+            return priority < other.priority || (priority == other.priority && tie < other.tie);
+        }
+    };
+
+    std::vector<Entry> heap;
+    std::vector<int> position;  /// Maps cell index -> position in heap, -1 if not queued.
+
+    void sift_up(std::size_t i);
+    void sift_down(std::size_t i);
+
+   public:
+    /**
+     * Sizes the position map for a grid with the given number of cells and empties the heap.
+     *
+     * @param cells Number of cells in the grid.
+     */
+    void prepare(int cells);
+
+    /**
+     * Empties the heap in O(size).
+     */
+    void clear();
+
+    bool empty() const { return heap.empty(); }
+    std::size_t size() const { return heap.size(); }
+    bool contains(int idx) const { return position[idx] >= 0; }
+
+    /**
+     * Calls f(idx) for every queued cell, in heap order.
+     */
+    template <typename F>
+    void for_each(F&& f) const {
+        for (auto const& entry : heap)
+            f(entry.idx);
+    }
+
+    /**
+     * Returns the pair <priority, cell index> with the smallest priority.
+     */
+    std::pair<int, int> top() const { return {heap.front().priority, heap.front().idx}; }
+
+    /**
+     * Returns the second key of the cell with the smallest priority.
+     */
+    int top_tie() const { return heap.front().tie; }
+
+    /**
+     * Queues a cell, or lowers its priority if it is already queued.
+     *
+     * @param priority Priority of the cell.
+     * @param idx Cell index.
+     * @param tie Second key for cells with the same priority.
+     */
+    void push(int priority, int idx, int tie = 0);
+
+    /**
+     * Queues a cell, or sets its priority if it is already queued, which may also raise it.
+     *
+     * @param priority Priority of the cell.
+     * @param idx Cell index.
+     * @param tie Second key for cells with the same priority.
+     */
+    void update(int priority, int idx, int tie = 0);
+
+    /**
+     * Removes a cell from the heap, if it is queued.
+     *
+     * @param idx Cell index.
+     */
+    void remove(int idx);
+
+    /**
+     * Removes the cell with the smallest priority.
+     *
+     * @return The pair <priority, cell index>.
+     */
+    std::pair<int, int> pop();
+};
+
+#endif  // MAZE_INDEXED_HEAP_H
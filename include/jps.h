@@ -0,0 +1,138 @@
+#ifndef MAZE_JPS_H
+#define MAZE_JPS_H
+
+#include <array>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Building blocks of Jump Point Search on uniform-cost grids.
+ * With 4-connected movement horizontal jumps stop at forced neighbors and vertical jumps also stop
+ * wherever a horizontal jump would find something. With 8-connected movement diagonal jumps stop
+ * wherever a straight jump would find something.
+ *
+ * See also https://en.wikipedia.org/wiki/Jump_point_search.
+ */
+namespace jps {
+
+struct Direction {
+    int dx;
+    int dy;
+};
+
+/// Movement directions in the order of Grid::for_each_neighbor.
+constexpr std::array<Direction, 8> directions{{
+    {-1, 0},
+    {1, 0},
+    {0, -1},
+    {0, 1},
+    {-1, -1},
+    {1, -1},
+    {-1, 1},
+    {1, 1},
+}};
+
+/**
+ * Returns the index of (dx, dy) in directions.
+ */
+constexpr int direction_index(int dx, int dy) {
+    if (dy == 0)
+        return dx < 0 ? 0 : 1;
+    if (dx == 0)
+        return dy < 0 ? 2 : 3;
+    return 4 + (dx > 0) + 2 * (dy > 0);
+}
+
+/**
+ * Returns true if the cell (x, y), entered with direction (dx, dy), has a forced neighbor.
+ */
+bool has_forced_neighbor(const Grid& grid, int x, int y, int dx, int dy);
+
+/**
+ * Calls f(dx, dy) for every direction in which a node entered with direction (dx, dy) has to be
+ * expanded. The start, entered with (0, 0), is expanded in every direction.
+ */
+template <typename F>
+void for_each_direction(const Grid& grid, int x, int y, int dx, int dy, F&& f) {
+    if (dx == 0 && dy == 0) {
+        for (auto i = 0; i < max_neighbors; ++i)
+            f(directions[i].dx, directions[i].dy);
+        return;
+    }
+
+    if constexpr (diagonal_movement) {
+        if (dx != 0 && dy != 0) {
+            f(dx, 0);
+            f(0, dy);
+            f(dx, dy);
+            if (!grid.open(x - dx, y))
+                f(-dx, dy);
+            if (!grid.open(x, y - dy))
+                f(dx, -dy);
+        } else if (dx != 0) {
+            f(dx, 0);
+            if (!grid.open(x, y + 1))
+                f(dx, 1);
+            if (!grid.open(x, y - 1))
+                f(dx, -1);
+        } else {
+            f(0, dy);
+            if (!grid.open(x + 1, y))
+                f(1, dy);
+            if (!grid.open(x - 1, y))
+                f(-1, dy);
+        }
+    } else {
+        if (dx != 0) {
+            f(dx, 0);
+            f(0, -1);
+            f(0, 1);
+        } else {
+            f(0, dy);
+            f(-1, 0);
+            f(1, 0);
+        }
+    }
+}
+
+/**
+ * Walks from (x, y) in direction (dx, dy) until it reaches a jump point or the goal.
+ *
+ * @return The cell index of the jump point, or -1 if the walk ends at an obstacle.
+ */
+int jump(const Grid& grid, int x, int y, int dx, int dy, int goal);
+
+/**
+ * Precomputed jump distances for JPS+.
+ * For every cell and direction it stores k > 0 if the next jump point is k steps away, or -k if
+ * k steps can be made before hitting an obstacle. Jump points only depend on the grid, the goal
+ * is handled when the table is queried.
+ */
+class JumpTable {
+   private:
+    int w{};
+    std::vector<int> dist;  /// max_neighbors entries per cell.
+
+    void build_direction(const Grid& grid, int dir);
+
+   public:
+    /**
+     * Recomputes every distance for the given grid.
+     */
+    void build(const Grid& grid);
+
+    int distance(int idx, int dir) const { return dist[static_cast<std::size_t>(idx) * max_neighbors + dir]; }
+
+    /**
+     * Returns the successor of (x, y) in direction (dx, dy): the goal, a jump point, or the cell
+     * on the way that lines up with the goal.
+     *
+     * @return The cell index of the successor, or -1 if there is none.
+     */
+    int jump(int x, int y, int dx, int dy, int goal_x, int goal_y) const;
+};
+
+}  // namespace jps
+
+#endif  // MAZE_JPS_H
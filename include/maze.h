@@ -1,23 +1,49 @@
 #ifndef MAZE_MAZE_H
 #define MAZE_MAZE_H
 
+#include <chrono>
+#include <cstdint>
 #include <list>
+#include <memory>
 #include <queue>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include "batch_search.h"
+#include "component_index.h"
+#include "d_star_lite.h"
+#include "distance_field.h"
+#include "generators.h"
+#include "grid.h"
+#include "grid_metrics.h"
+#include "hpa.h"
+#include "jps.h"
+#include "maze_file.h"
+#include "parallel_bfs.h"
+#include "search_trace.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+#include "wavefront.h"
+
 auto const HEIGHT = 10;
 auto const WIDTH = 10;
 
-enum class Heuristics {
-    Dijkstra,
-    Manhattan,
-    Euclidean,
+/**
+ * Priority queue used by dijkstra and a_star.
+ */
+enum class PriorityQueue {
+    Heap,        /// Indexed 4-ary heap with decrease-key, O(log n) per operation.
+    Buckets,     /// O(1) per operation, for small integer edge costs (Dial's algorithm).
 };
 
+/**
+ * A value view of a single cell of the maze.
+ * Nodes are not stored in the maze, they are computed from the cell index on demand.
+ */
 struct Node {
-    int id{};             /// Id of the field.
+    int id{};             /// Id of the field, which is the row-major cell index.
     int x{};              /// X coordinate of the field.
     int y{};              /// Y coordinate of the field.
     bool start{false};    /// True if the field is the starting point.
@@ -31,34 +57,107 @@ struct Node {
 };
 
 /**
- * Maze data structure implemented with a grid of fields.
+ * Maze data structure implemented with a bit-packed grid of fields.
  */
 class Maze {
    private:
     int w;
     int h;
 
+    Grid grid;         /// Passability of every cell.
+    int start_idx{};   /// Cell index of the starting point.
+    int end_idx{};     /// Cell index of the end point.
+
+    SearchWorkspace workspace;           /// Bookkeeping reused by every search on this maze.
+    SearchWorkspace backward_workspace;  /// Bookkeeping of the backward half of bidirectional searches.
+
+    jps::JumpTable jump_table;     /// Jump distances for JPS+.
+    bool jump_table_dirty{true};   /// True if the grid changed since jump_table was built.
+
+    std::unique_ptr<ThreadPool> pool;  /// Threads of parallel_bfs and batch_a_star, started on first use.
+    ParallelBfs parallel;              /// Bitmaps and buffers of parallel_bfs.
+    BatchSearch batch;                 /// Workspaces and buffers of batch_a_star.
+    Wavefront wavefront;               /// Bitmaps of wavefront_bfs.
+    std::vector<int> wavefront_path;   /// Path of the last wavefront_bfs.
+
+    hpa::Graph hierarchy;          /// Abstract graph for hpa_star.
+    bool hierarchy_built{false};   /// False until the first hpa_star and after clear_maze.
+
+    DStarLite planner;             /// State of d_star_lite, kept between searches.
+
+    ComponentIndex components;     /// Connected components, checked before every search.
+    std::vector<Query> reachable;  /// Queries of batch_a_star, unreachable ones replaced by an invalid query.
+
+    DistanceField field;           /// Field of the last distance_field.
+
+    /**
+     * Returns the thread pool, restarted if it does not have the requested number of threads.
+     *
+     * @param threads Number of threads, 0 for one per hardware thread.
+     */
+    ThreadPool& thread_pool(unsigned threads);
+
+    /**
+     * A helper function for dijkstra.
+     */
+    template <typename Queue>
+    SearchTrace _dijkstra(Queue& pq);
+
     /**
      * A helper function for a_star.
      */
+    template <typename Heuristic, typename Queue>
+    SearchTrace _a_star(Heuristic h, Queue& pq);
+
+    /**
+     * Runs _a_star with the given heuristic on the chosen priority queue.
+     */
     template <typename Heuristic>
-    std::pair<std::deque<Node>, std::deque<Node>> _a_star(Heuristic h);
+    SearchTrace _a_star(Heuristic h, PriorityQueue queue);
 
     /**
-     * A helper function to print the elapsed time between t1 and t2.
+     * A helper function for jps and jps_plus.
      *
-     * @tparam Clock
-     * @param t1 Timestamp 1.
-     * @param t2 Timestamp 2.
+     * @param jump Returns the successor of a node in a direction, or -1.
      */
-    template <typename Clock>
-    void print_elapsed_time(std::chrono::time_point<Clock> t1, std::chrono::time_point<Clock> t2);
+    template <typename Jump>
+    SearchTrace _jps(Jump jump, const char* algorithm);
 
-   public:
-    Node start;
-    Node end;
+    /**
+     * Adds the path of a bidirectional search to the trace.
+     *
+     * @param meet Cell reached by both searches on the shortest path.
+     */
+    void add_bidirectional_path(SearchTrace& trace, int meet) const;
 
-    std::vector<std::vector<Node>> maze;
+    SearchObserver observer;  /// Notified after every search, if set.
+    SearchTrace::Sink sink;   /// Receives the visited cells of every search instead of its trace, if set.
+
+    /**
+     * Completes the statistics of a finished search and notifies the observer.
+     *
+     * @param trace The trace of the search.
+     * @param algorithm Name of the algorithm.
+     * @param t1 Timestamp taken before the first expansion.
+     * @param cost Cost of the path to the end, -1 if the end was not reached.
+     */
+    void finish_search(SearchTrace& trace, const char* algorithm, std::chrono::steady_clock::time_point t1, int cost) const;
+
+    /**
+     * Finishes the search with an empty path if the end is not in the component of the start.
+     *
+     * @param trace The trace of the search, which stays empty if the end is not reachable.
+     * @param algorithm Name of the algorithm.
+     * @return True if the end is not reachable and the search is finished.
+     */
+    bool reject_unreachable(SearchTrace& trace, const char* algorithm);
+
+    /**
+     * Returns a maze on the given grid.
+     */
+    Maze(Grid cells, int start, int end);
+
+   public:
 
     /**
      * Returns a maze with random start and end points.
@@ -72,6 +171,42 @@ class Maze {
      */
     explicit Maze(bool random = false, int width = WIDTH, int height = HEIGHT, int prob = 7);
 
+    /**
+     * Same as above, but the maze is generated from the given seed, so it can be reproduced.
+     *
+     * @param seed Seed of the random number generator.
+     */
+    Maze(bool random, int width, int height, int prob, std::uint32_t seed);
+
+    /**
+     * Returns a perfect maze, where there is exactly one path between any two passable cells.
+     * The start is in the top left corner and the end in the room farthest down and right.
+     *
+     * @param algorithm The maze generator.
+     * @param width Number of columns in the maze.
+     * @param height Number of rows in the maze.
+     * @param seed Seed of the random number generator.
+     */
+    static Maze generate(generators::Algorithm algorithm, int width, int height, std::uint32_t seed);
+
+    /**
+     * Loads a maze written by save. The file is mapped into memory and searched in place, so
+     * loading does not depend on the size of the maze. Changes to the loaded maze are not written
+     * back to the file.
+     *
+     * @param path Path of the maze file.
+     * @throws std::runtime_error if the file cannot be opened or is not a valid maze file.
+     */
+    static Maze load(const std::string& path);
+
+    /**
+     * Writes the maze to a file, see maze_file.h for the format.
+     *
+     * @param path Path of the maze file.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& path) const;
+
     /**
      * Delete the old start and set a new one.
      *
@@ -89,11 +224,75 @@ class Maze {
     void set_end(int x, int y);
 
     /**
-     * Returns a vector with all neighbots
+     * Sets the observer that is called with the statistics of every search.
+     * Pass an empty function to remove it.
+     *
+     * @param o The observer.
+     */
+    void set_observer(SearchObserver o) { observer = std::move(o); }
+
+    /**
+     * Sets the sink that receives the visited cells of every search as they are visited. The
+     * returned traces then only hold the path and the statistics. A sink that throws aborts the
+     * search, the maze stays usable for further searches.
+     * Pass an empty function to remove it.
+     *
+     * @param s The sink.
+     */
+    void set_trace_sink(SearchTrace::Sink s) { sink = std::move(s); }
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    /**
+     * Returns the underlying passability plane.
+     */
+    const Grid& get_grid() const { return grid; }
+
+    /**
+     * Returns a node view of the cell with the given index.
+     *
+     * @param idx Row-major cell index.
+     */
+    Node get_node(int idx) const;
+
+    /**
+     * Returns a node view of the cell at (x, y).
+     *
+     * @param x x-coordinate.
+     * @param y y-coordinate.
+     */
+    Node get_node(int x, int y) const { return get_node(grid.index(x, y)); }
+
+    Node get_start() const { return get_node(start_idx); }
+    Node get_end() const { return get_node(end_idx); }
+
+    bool is_passable(int x, int y) const { return grid.passable(x, y); }
+
+    /**
+     * Marks the cell at (x, y) as passable or impassable.
+     *
+     * @param x x-coordinate.
+     * @param y y-coordinate.
+     * @param passable True if one can enter the cell.
+     */
+    void set_passable(int x, int y, bool passable);
+
+    /**
+     * Returns all passable neighbors of a node as cell indices. Never allocates.
      *
      * @param node The node whose neighbors we want to get.
      */
-    std::vector<Node> get_neighbors(const Node& node);
+    Neighbors get_neighbors(const Node& node) const { return grid.neighbors(node.id); }
+
+    /**
+     * Calls f(neighbor_idx) for every passable neighbor of the cell idx.
+     *
+     * @param idx The cell whose neighbors we want to visit.
+     * @param f Visitor taking the neighbor's cell index.
+     */
+    template <typename F>
+    void for_each_neighbor(int idx, F&& f) const { grid.for_each_neighbor(idx, std::forward<F>(f)); }
 
     /**
      * Makes every node in the maze passable.
@@ -111,18 +310,44 @@ class Maze {
      *
      * See also https://en.wikipedia.org/wiki/Breadth-first_search.
      *
-     * @return Every node in the order it was visited.
+     * @return A trace with every cell in the order it was visited.
      */
-    std::deque<Node> bfs();
+    SearchTrace bfs();
+
+    /**
+     * Find the end point in the maze with a parallel breadth first search, meant for very large
+     * mazes. Every level of the frontier is expanded on a thread pool, either top-down from the
+     * frontier or bottom-up from the unvisited cells, depending on the size of the frontier.
+     * The distances are the same as the ones of bfs, the cells of a level may be visited in a
+     * different order.
+     *
+     * @param threads Number of threads, 0 for one per hardware thread.
+     * @return A trace with every cell level by level in the order it was visited, and the shortest path.
+     *         The path is empty if the end is not reachable.
+     */
+    SearchTrace parallel_bfs(unsigned threads = 0);
+
+    /**
+     * Find the shortest path to the end point of the maze with a bit-parallel breadth first
+     * search, which advances whole words of the grid per level with the widest SIMD kernel the
+     * CPU supports. Meant for large open mazes, where a level spans many cells.
+     *
+     * See also Wavefront.
+     *
+     * @return A trace with only the shortest path, the cells are not visited one by one. The
+     *         counters hold the number of visited cells and levels. The path is empty if the end
+     *         is not reachable.
+     */
+    SearchTrace wavefront_bfs();
 
     /**
      * Find the end point in the maze with depth first search.
      *
      * See also https://en.wikipedia.org/wiki/Depth-first_search.
      *
-     * @return Every node in the order it was visited.
+     * @return A trace with every cell in the order it was visited.
      */
-    std::deque<Node> dfs();
+    SearchTrace dfs();
 
     /**
      * Find the shortest path to the end point of the maze with dijkstra's algorithm.
@@ -130,9 +355,10 @@ class Maze {
      *
      * See also https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm.
      *
-     * @return Two queues, one containing every visited node and one the shortest path.
+     * @param queue The priority queue to use.
+     * @return A trace with every visited cell and the shortest path.
      */
-    std::pair<std::deque<Node>, std::deque<Node>> dijkstra();
+    SearchTrace dijkstra(PriorityQueue queue = PriorityQueue::Heap);
 
     /**
      * Find the shortest path to the end point of the maze with the A* algorithm.
@@ -140,9 +366,106 @@ class Maze {
      * See also https://en.wikipedia.org/wiki/A*_search_algorithm.
      *
      * @param h The heuristics to choose. Possible are Dijkstra (h always returns 0), Manhattan and Euclidean.
-     * @return Two queue, one containing every visited node and one the shortest path.
+     * @param queue The priority queue to use.
+     * @return A trace with every visited cell and the shortest path.
+     */
+    SearchTrace a_star(Heuristics h = Heuristics::Manhattan, PriorityQueue queue = PriorityQueue::Heap);
+
+    /**
+     * Find the shortest path to the end point of the maze with Jump Point Search.
+     * Only jump points are expanded, the path between them is filled in afterwards.
+     *
+     * See also https://en.wikipedia.org/wiki/Jump_point_search.
+     *
+     * @return A trace with every expanded jump point and the shortest path.
+     *         The path is empty if the end is not reachable.
+     */
+    SearchTrace jps();
+
+    /**
+     * Find the shortest path to the end point of the maze with JPS+.
+     * Same as jps, but the jumps are looked up in a precomputed table, which is rebuilt on the
+     * first search after the maze changed.
+     *
+     * @return A trace with every expanded jump point and the shortest path.
+     *         The path is empty if the end is not reachable.
+     */
+    SearchTrace jps_plus();
+
+    /**
+     * Find the shortest path to the end point of the maze with two breadth first searches, one
+     * from the start and one from the end, until they meet.
+     * Every round expands one whole level of the side with the smaller frontier.
+     *
+     * See also https://en.wikipedia.org/wiki/Bidirectional_search.
+     *
+     * @return A trace with every visited cell, cells of the backward search are marked, and the
+     *         shortest path. The path is empty if the end is not reachable.
+     */
+    SearchTrace bidirectional_bfs();
+
+    /**
+     * Find the shortest path to the end point of the maze with two A* searches, one from the start
+     * and one from the end. The searches stop once the shortest path found so far is not longer
+     * than the smallest f_score of one of the queues.
+     *
+     * See also https://en.wikipedia.org/wiki/Bidirectional_search.
+     *
+     * @return A trace with every visited cell, cells of the backward search are marked, and the
+     *         shortest path. The path is empty if the end is not reachable.
+     */
+    SearchTrace bidirectional_a_star();
+
+    /**
+     * Find a path to the end point of the maze with hierarchical path-finding A* (HPA*).
+     * The abstract graph of the clusters is built on the first search. Afterwards only the
+     * clusters next to changed cells are rebuilt on the next search.
+     *
+     * See also hpa::Graph.
+     *
+     * @return A trace with every expanded abstract node and the path, which is near-optimal.
+     *         The path is empty if the end is not reachable.
+     */
+    SearchTrace hpa_star();
+
+    /**
+     * Find the shortest path to the end point of the maze with D* Lite. The planner keeps its
+     * state between searches: after cells changed or the start moved, only the part of the search
+     * affected by the change is repeated. A new end point starts over from scratch.
+     *
+     * See also DStarLite.
+     *
+     * @return A trace with every cell expanded by this search and the shortest path.
+     *         The path is empty if the end is not reachable.
+     */
+    SearchTrace d_star_lite();
+
+    /**
+     * Finds the shortest paths of many queries at once with A*. The queries run concurrently on a
+     * thread pool, each thread with its own workspace, while the maze is only read. The start and
+     * end point of the maze are not used and not changed.
+     *
+     * @param queries Start and end cell indices of every query.
+     * @param threads Number of threads, 0 for one per hardware thread.
+     * @return The shortest paths in the order of the queries. A path is empty if its end is not reachable.
+     */
+    PathBatch batch_a_star(const std::vector<Query>& queries, unsigned threads = 0);
+
+    /**
+     * Computes the distance of every cell to the nearest goal in one breadth first search from all
+     * goals, for many agents heading for the same goals. Each agent follows the field with
+     * DistanceField::next or DistanceField::path instead of running its own search.
+     *
+     * @param goals Cell indices of the goals.
+     * @param with_directions True to keep the neighbor to step to per cell.
+     * @return The field, which stays valid until the next call.
+     */
+    const DistanceField& distance_field(const std::vector<int>& goals, bool with_directions = true);
+
+    /**
+     * Computes the distance of every cell to the end point.
      */
-    std::pair<std::deque<Node>, std::deque<Node>> a_star(Heuristics h = Heuristics::Manhattan);
+    const DistanceField& distance_field(bool with_directions = true) { return distance_field({end_idx}, with_directions); }
 };
 
 #endif  // MAZE_MAZE_H
@@ -0,0 +1,129 @@
+#ifndef MAZE_MAZE_FILE_H
+#define MAZE_MAZE_FILE_H
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "grid.h"
+
+/**
+ * Binary maze files, which are loaded by mapping them into memory instead of parsing them.
+ *
+ * A file consists of
+ * - a Header of 64 bytes,
+ * - the passability plane, packed exactly like the plane of Grid: one bit per cell, rows of
+ *   words_per_row little-endian 64-bit words and zero bits past the width,
+ * - a Trailer with the start and the end.
+ *
+ * The start and end follow the plane, so a maze can be written row by row, for example by
+ * generators::EllerStream, before they are known.
+ */
+namespace maze_file {
+
+constexpr std::array<char, 8> magic{'M', 'A', 'Z', 'E', 'G', 'R', 'I', 'D'};
+constexpr std::uint32_t version = 1;
+
+struct Header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t header_size;  /// Number of bytes before the plane.
+    std::uint64_t width;
+    std::uint64_t height;
+    std::uint64_t words_per_row;
+    std::array<std::uint64_t, 3> reserved;
+};
+
+struct Trailer {
+    std::uint64_t start;  /// Cell index of the starting point.
+    std::uint64_t end;    /// Cell index of the end point.
+};
+
+static_assert(sizeof(Header) == 64, "the plane starts at a 64 byte offset");
+static_assert(sizeof(Trailer) == 16, "the trailer has no padding");
+
+/**
+ * Returns the number of bytes of the plane of a file.
+ */
+inline std::uint64_t plane_bytes(const Header& header) {
+    return header.words_per_row * header.height * sizeof(std::uint64_t);
+}
+
+/**
+ * Checks that the header describes a maze file of the given size this version can read.
+ *
+ * @throws std::runtime_error if it does not.
+ */
+void check_header(const Header& header, std::uint64_t file_size, const std::string& path);
+
+/**
+ * Checks that the start and end of a file lie inside its maze.
+ *
+ * @throws std::runtime_error if they do not.
+ */
+void check_trailer(const Header& header, const Trailer& trailer, const std::string& path);
+
+/**
+ * A maze loaded from a file.
+ */
+struct Contents {
+    Grid grid;  /// Views the mapped plane.
+    int start;  /// Cell index of the starting point.
+    int end;    /// Cell index of the end point.
+};
+
+/**
+ * Writes a maze file row by row.
+ */
+class Writer {
+   private:
+    std::ofstream out;
+    int w;
+    int h;
+    int stride;   /// Number of 64-bit words per row.
+    int rows{};   /// Number of rows written.
+
+   public:
+    /**
+     * Creates the file and writes the header. The number of cells is not limited, but only
+     * TiledGrid can read mazes with more cells than fit into an int.
+     *
+     * @throws std::runtime_error if the file cannot be created or the grid is too large. A grid
+     *         that is too large leaves an existing file untouched.
+     */
+    Writer(const std::string& path, int width, int height);
+
+    /**
+     * Appends the next row, packed like a row of Grid.
+     */
+    void write_row(const std::uint64_t* row);
+
+    /**
+     * Writes the start and end after the last row and closes the file.
+     *
+     * @throws std::runtime_error if not every row was written or the file cannot be written.
+     */
+    void finish(std::uint64_t start, std::uint64_t end);
+};
+
+/**
+ * Maps a maze file into memory. Apart from the last word of every row, which is checked for bits
+ * set past the width, nothing is read until a cell is accessed. Changes of the grid are private
+ * copies of the touched pages and are never written back to the file.
+ *
+ * @throws std::runtime_error if the file cannot be opened, is not a valid maze file or has more
+ *         cells than fit into an int.
+ */
+Contents load(const std::string& path);
+
+/**
+ * Writes a grid and its start and end to a file.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void save(const std::string& path, const Grid& grid, int start, int end);
+
+}  // namespace maze_file
+
+#endif  // MAZE_MAZE_FILE_H
@@ -0,0 +1,68 @@
+#ifndef MAZE_PARALLEL_BFS_H
+#define MAZE_PARALLEL_BFS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "grid.h"
+#include "search_trace.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+/**
+ * Level-synchronous breadth first search that expands every level of the frontier on a thread pool.
+ *
+ * A level is expanded either top-down, where the frontier cells claim their unvisited neighbors, or
+ * bottom-up, where every unvisited cell looks for a neighbor in a bitmap of the frontier. Bottom-up
+ * is chosen while the frontier is large compared to the unvisited part of the grid, which saves the
+ * contended claims of a top-down step.
+ *
+ * See also Beamer et al., "Direction-Optimizing Breadth-First Search".
+ *
+ * The buffers are kept between searches, so repeated searches on one maze do not allocate.
+ */
+class ParallelBfs {
+   private:
+    using Bits = std::unique_ptr<std::atomic<std::uint64_t>[]>;
+
+    Bits visited;              /// One bit per cell, set for visited and impassable cells and the padding.
+    Bits in_frontier;          /// One bit per cell of the current level, only used bottom-up.
+    std::size_t words{};       /// Number of words of the bitmaps.
+    std::size_t capacity{};    /// Number of allocated words of the bitmaps.
+
+    std::vector<int> frontier;                /// Cells of the current level.
+    std::vector<int> next;                    /// Cells of the next level.
+    std::vector<std::vector<int>> chunks;     /// Cells found by every chunk of a step, in chunk order.
+
+    /**
+     * Marks every impassable cell as visited and returns the number of passable cells.
+     */
+    std::size_t prepare(const Grid& grid, ThreadPool& pool);
+
+    /**
+     * Claims the unvisited neighbors of the frontier. Returns the number of chunks.
+     */
+    std::size_t top_down(const Grid& grid, SearchWorkspace& workspace, ThreadPool& pool, int distance);
+
+    /**
+     * Visits every unvisited cell with a neighbor in the frontier. Returns the number of chunks.
+     */
+    std::size_t bottom_up(const Grid& grid, SearchWorkspace& workspace, ThreadPool& pool, int distance);
+
+   public:
+    /**
+     * Searches from start until the level containing end is reached or every reachable cell was
+     * visited. Distances and predecessors are recorded in the workspace, which must be prepared
+     * for the grid. The trace receives the cells level by level, up to and including end, and
+     * the counters of the search.
+     *
+     * @return The number of levels that were expanded bottom-up.
+     */
+    std::size_t run(const Grid& grid, SearchWorkspace& workspace, ThreadPool& pool, int start, int end,
+                    SearchTrace& trace);
+};
+
+#endif  // MAZE_PARALLEL_BFS_H
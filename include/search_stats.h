@@ -0,0 +1,27 @@
+#ifndef MAZE_SEARCH_STATS_H
+#define MAZE_SEARCH_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Counters collected by every search.
+ */
+struct SearchStats {
+    std::int64_t wall_time_ns{};      /// Time from the first expansion until the trace is complete.
+    std::size_t expanded{};           /// Nodes taken from the frontier and expanded.
+    std::size_t generated{};          /// Nodes reached for the first time.
+    std::size_t pushes{};             /// Pushes to the frontier after the start, including decrease-key.
+    std::size_t pops{};               /// Pops from the frontier, including stale entries.
+    std::size_t peak_frontier{};      /// Largest size of the frontier.
+    std::size_t path_length{};        /// Number of cells on the returned path.
+    int path_cost{-1};                /// Cost of the path to the end that was found, -1 if the end was not reached.
+};
+
+/**
+ * Called after every search with the name of the algorithm and its statistics.
+ */
+using SearchObserver = std::function<void(const char* algorithm, const SearchStats& stats)>;
+
+#endif  // MAZE_SEARCH_STATS_H
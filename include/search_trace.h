@@ -0,0 +1,102 @@
+#ifndef MAZE_SEARCH_TRACE_H
+#define MAZE_SEARCH_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "search_stats.h"
+
+/**
+ * Result of a search: the cells in the order they were visited, followed by the cells of the
+ * shortest path from start to end.
+ * Both are stored as packed 32-bit cell indices in one contiguous buffer, so a step costs
+ * four bytes and any step can be accessed in O(1).
+ * A trace is move-only, handing it off never copies the buffer.
+ * Bidirectional searches mark the cells visited by the backward search with the highest bit.
+ *
+ * A trace with a sink passes the visited cells to the sink instead of storing them, so they can be
+ * consumed while the search is still running. Only the path is stored then.
+ */
+class SearchTrace {
+   public:
+    /// Receives every visited cell, may throw to abort the search.
+    using Sink = std::function<void(int idx, bool backward)>;
+
+   private:
+    std::vector<std::uint32_t> cells;  /// Visited cells followed by the path cells.
+    std::size_t visited_count{};       /// Number of visited cells at the front of cells.
+
+    static constexpr std::uint32_t backward_bit = std::uint32_t{1} << 31;
+
+    SearchStats search_stats;
+    Sink sink;  /// Receives the visited cells instead of cells, if set.
+
+   public:
+    SearchTrace() = default;
+    explicit SearchTrace(Sink s) : sink(std::move(s)) {}
+    SearchTrace(const SearchTrace&) = delete;
+    SearchTrace& operator=(const SearchTrace&) = delete;
+    SearchTrace(SearchTrace&&) noexcept = default;
+    SearchTrace& operator=(SearchTrace&&) noexcept = default;
+
+    /**
+     * Appends a cell to the visited order. Must be called before any path cell is added.
+     *
+     * @param idx Cell index.
+     * @param backward True if the cell was visited by the backward search of a bidirectional search.
+     */
+    void add_visited(int idx, bool backward = false) {
+        if (sink) {
+            sink(idx, backward);
+            return;
+        }
+        cells.push_back(static_cast<std::uint32_t>(idx) | (backward ? backward_bit : 0));
+        ++visited_count;
+    }
+
+    /**
+     * Appends a cell to the path.
+     *
+     * @param idx Cell index.
+     */
+    void add_path(int idx) { cells.push_back(static_cast<std::uint32_t>(idx)); }
+
+    /**
+     * Reverses the path in place. Used when the path was added from the end to the start.
+     */
+    void reverse_path();
+
+    std::size_t visited_size() const { return visited_count; }
+    std::size_t path_size() const { return cells.size() - visited_count; }
+
+    int visited(std::size_t i) const { return static_cast<int>(cells[i] & ~backward_bit); }
+    bool visited_backward(std::size_t i) const { return (cells[i] & backward_bit) != 0; }
+    int path(std::size_t i) const { return static_cast<int>(cells[visited_count + i]); }
+
+    /**
+     * Returns true if the search reached the end, false if there is no path.
+     */
+    bool found() const { return search_stats.path_cost >= 0; }
+
+    SearchStats& stats() { return search_stats; }
+    const SearchStats& stats() const { return search_stats; }
+
+    /**
+     * Removes every step and the statistics, but keeps the allocated buffer.
+     */
+    void clear() {
+        cells.clear();
+        visited_count = 0;
+        search_stats = SearchStats{};
+    }
+
+    /**
+     * Returns the number of bytes used by the buffer.
+     */
+    std::size_t memory_bytes() const { return cells.capacity() * sizeof(std::uint32_t); }
+};
+
+#endif  // MAZE_SEARCH_TRACE_H
@@ -0,0 +1,100 @@
+#ifndef MAZE_SEARCH_WORKER_H
+#define MAZE_SEARCH_WORKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+
+#include "maze.h"
+#include "spsc_ring.h"
+#include "search_trace.h"
+
+/**
+ * Runs one search at a time on a background thread and streams its visited cells to the thread
+ * that started it, so a window can keep drawing and polling events while the search runs.
+ *
+ * The cells go through a lock-free ring buffer. If the consumer falls behind, the search waits
+ * for free slots. Cancelling makes the next visited cell abort the search with an exception that
+ * is caught on the worker, which takes at most one expansion.
+ *
+ * The maze must not be changed while a search runs on it.
+ */
+class SearchWorker {
+   public:
+    /// Search to run, e.g. [](Maze& m) { return m.bfs(); }.
+    using Search = std::function<SearchTrace(Maze&)>;
+
+    static constexpr std::size_t ring_capacity = std::size_t{1} << 16;  /// Cells in flight at most.
+
+   private:
+    static constexpr std::uint32_t backward_bit = std::uint32_t{1} << 31;
+
+    SpscRing<std::uint32_t> ring{ring_capacity};  /// Visited cells, the backward bit like in SearchTrace.
+    std::thread thread;
+    Maze* maze{};  /// Maze of the running search, its sink feeds the ring.
+
+    std::atomic<bool> cancelled{false};  /// Set by cancel, checked on every visited cell.
+    std::atomic<bool> done{false};       /// Set by the worker after its last cell was pushed.
+
+    SearchTrace result;        /// Path and statistics of the finished search.
+    std::exception_ptr error;  /// Exception thrown by the search, other than the cancellation.
+
+    /**
+     * Waits for the worker and detaches the sink from the maze.
+     */
+    void join();
+
+   public:
+    SearchWorker() = default;
+    ~SearchWorker();
+
+    SearchWorker(const SearchWorker&) = delete;
+    SearchWorker& operator=(const SearchWorker&) = delete;
+
+    /**
+     * Starts a search on the worker thread, cancelling the running one.
+     *
+     * @param m The maze to search, which must outlive the search.
+     * @param search The search to run on the maze.
+     */
+    void start(Maze& m, Search search);
+
+    /**
+     * Aborts the running search and waits for the worker. Cells not drained yet are dropped.
+     */
+    void cancel();
+
+    /**
+     * Returns true from start until the result was taken or the search was cancelled.
+     */
+    bool busy() const { return thread.joinable(); }
+
+    /**
+     * Returns true once the search returned. Cells drained after this returned true are the
+     * last ones.
+     */
+    bool finished() const { return done.load(std::memory_order_acquire); }
+
+    /**
+     * Calls f(idx, backward) for every cell visited since the last call, in the order of the search.
+     *
+     * @return Number of cells.
+     */
+    template <typename F>
+    std::size_t drain(F&& f) {
+        return ring.pop_all([&f](std::uint32_t cell) { f(static_cast<int>(cell & ~backward_bit), (cell & backward_bit) != 0); });
+    }
+
+    /**
+     * Returns the trace of the finished search, which holds the path and the statistics but no
+     * visited cells. The worker is idle afterwards.
+     *
+     * @throws Any exception thrown by the search.
+     */
+    SearchTrace take();
+};
+
+#endif  // MAZE_SEARCH_WORKER_H
@@ -0,0 +1,65 @@
+#ifndef MAZE_SEARCH_WORKSPACE_H
+#define MAZE_SEARCH_WORKSPACE_H
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "bucket_queue.h"
+#include "indexed_heap.h"
+
+/**
+ * Dense per-cell bookkeeping shared by the search algorithms.
+ * The arrays are sized to the grid once and reset in O(1) between queries with a generation
+ * stamp: a cell is only considered visited if its stamp equals the current generation.
+ * Reusing one workspace for repeated queries on the same maze does not allocate.
+ */
+class SearchWorkspace {
+   private:
+    std::vector<std::uint32_t> stamp;  /// Generation in which the cell was last visited.
+    std::vector<int> dist;             /// Distance from the start, valid if visited.
+    std::vector<int> parent;           /// Predecessor on the current best path, valid if visited.
+    std::uint32_t generation{0};
+
+   public:
+    static constexpr int infinity = std::numeric_limits<int>::max();
+
+    std::vector<int> frontier;                /// Reusable queue/stack buffer.
+    IndexedHeap heap;                         /// Reusable heap with decrease-key.
+    BucketQueue buckets;                      /// Reusable bucket queue.
+
+    /**
+     * Sizes the workspace for a grid with the given number of cells and starts a new query.
+     *
+     * @param cells Number of cells in the grid.
+     */
+    void prepare(int cells);
+
+    /**
+     * Starts a new query. Every cell becomes unvisited in O(1).
+     */
+    void reset();
+
+    int size() const { return static_cast<int>(stamp.size()); }
+
+    bool visited(int idx) const { return stamp[idx] == generation; }
+
+    /**
+     * Marks a cell as visited and records its distance and predecessor.
+     *
+     * @param idx Cell index.
+     * @param distance Distance from the start.
+     * @param prev Predecessor of the cell, the start is its own predecessor.
+     */
+    void visit(int idx, int distance, int prev) {
+        stamp[idx] = generation;
+        dist[idx] = distance;
+        parent[idx] = prev;
+    }
+
+    int distance(int idx) const { return visited(idx) ? dist[idx] : infinity; }
+    int parent_of(int idx) const { return parent[idx]; }
+};
+
+#endif  // MAZE_SEARCH_WORKSPACE_H
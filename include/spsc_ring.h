@@ -0,0 +1,106 @@
+#ifndef MAZE_SPSC_RING_H
+#define MAZE_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Lock-free ring buffer for one producer thread and one consumer thread.
+ *
+ * The producer only writes tail and the consumer only writes head, so neither waits for the
+ * other. Each side keeps a copy of the other side's index and only reloads it when the ring looks
+ * full or empty, which keeps the shared cache lines from bouncing on every item.
+ */
+template <typename T>
+class SpscRing {
+   private:
+    std::vector<T> slots;
+    std::size_t mask;
+
+    alignas(64) std::atomic<std::size_t> head{0};  /// Next slot to pop, written by the consumer.
+    std::size_t cached_tail{0};                    /// Last tail seen by the consumer.
+
+    alignas(64) std::atomic<std::size_t> tail{0};  /// Next slot to push, written by the producer.
+    std::size_t cached_head{0};                    /// Last head seen by the producer.
+
+    static std::size_t round_up(std::size_t n) {
+        std::size_t res = 1;
+        while (res < n)
+            res <<= 1;
+        return res;
+    }
+
+   public:
+    /**
+     * @param capacity Minimum number of items, rounded up to a power of two.
+     */
+    explicit SpscRing(std::size_t capacity) : slots(round_up(capacity)), mask(slots.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return slots.size(); }
+
+    /**
+     * Appends an item. Producer only.
+     *
+     * @return False if the ring is full.
+     */
+    bool push(const T& item) {
+        auto const t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head == slots.size()) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head == slots.size())
+                return false;
+        }
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest item. Consumer only.
+     *
+     * @return False if the ring is empty.
+     */
+    bool pop(T& item) {
+        auto const h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail)
+                return false;
+        }
+        item = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Calls f(item) for every item pushed so far, oldest first, and removes them at once.
+     * Consumer only.
+     *
+     * @return Number of items removed.
+     */
+    template <typename F>
+    std::size_t pop_all(F&& f) {
+        auto const h = head.load(std::memory_order_relaxed);
+        cached_tail = tail.load(std::memory_order_acquire);
+        for (auto i = h; i != cached_tail; ++i)
+            f(slots[i & mask]);
+        head.store(cached_tail, std::memory_order_release);
+        return cached_tail - h;
+    }
+
+    /**
+     * Removes every item. Neither side may use the ring meanwhile.
+     */
+    void clear() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        cached_head = 0;
+        cached_tail = 0;
+    }
+};
+
+#endif  // MAZE_SPSC_RING_H
@@ -0,0 +1,136 @@
+#ifndef MAZE_STEPPED_SEARCH_H
+#define MAZE_STEPPED_SEARCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "grid.h"
+#include "maze.h"
+#include "search_stats.h"
+#include "search_workspace.h"
+
+/**
+ * Search that runs a few steps at a time, for animating the algorithm while it runs.
+ *
+ * A step takes one node from the frontier and expands it, so stepping to the end visits the nodes
+ * in the same order as the search of the same name on Maze. No visited order is recorded, the
+ * caller sees the nodes closed and opened by the last call to step and can inspect the frontier
+ * between calls.
+ *
+ * The search reads the grid of the maze on every step, so the maze must outlive it and must not
+ * change until it is done.
+ */
+class SteppedSearch {
+   public:
+    enum class Algorithm {
+        Bfs,       /// Breadth first search.
+        Dfs,       /// Depth first search.
+        Dijkstra,  /// Dijkstra's algorithm.
+        AStar,     /// A* with the given heuristics.
+    };
+
+   private:
+    const Grid& grid;
+    int start;
+    int end;
+    Algorithm algorithm;
+    Heuristics heuristic;
+
+    SearchWorkspace workspace;  /// Distances and predecessors, the frontier as queue, stack or heap.
+    std::size_t head{};        /// Front of the queue of BFS in workspace.frontier.
+
+    int cur{-1};            /// Node taken by the last step, -1 before the first.
+    bool finished{false};  /// True once the end was taken or the frontier ran empty.
+    SearchStats search_stats;
+
+    std::vector<int> opened_cells;  /// Nodes reached for the first time by the last call to step.
+    std::vector<int> closed_cells;  /// Nodes taken by the last call to step, in order.
+
+    /**
+     * Returns the estimated distance of a node to the end.
+     */
+    int h(int idx) const;
+
+    /**
+     * Takes one node from the frontier and expands it.
+     *
+     * @return False if the frontier was empty.
+     */
+    bool step_once();
+
+   public:
+    /**
+     * Starts a search from the start to the end of a maze. No node is taken yet.
+     *
+     * @param heuristic Heuristics of AStar, ignored by the other algorithms.
+     */
+    SteppedSearch(const Maze& maze, Algorithm algorithm, Heuristics heuristic = Heuristics::Manhattan);
+
+    /**
+     * Runs up to n steps, or fewer if the search finishes or the time budget runs out first.
+     * The time is checked every few steps, so the budget may be exceeded slightly.
+     *
+     * @param budget Time the steps may take, zero for no limit.
+     * @return Number of steps taken.
+     */
+    std::size_t step(std::size_t n = 1, std::chrono::nanoseconds budget = std::chrono::nanoseconds::zero());
+
+    /**
+     * Returns true once the end was reached or every reachable node was taken.
+     */
+    bool done() const { return finished; }
+
+    /**
+     * Returns true if the search is done and reached the end.
+     */
+    bool found() const { return finished && cur == end; }
+
+    /**
+     * Returns the node taken by the last step, -1 before the first.
+     */
+    int current() const { return cur; }
+
+    /**
+     * Returns the nodes reached for the first time by the last call to step.
+     */
+    const std::vector<int>& opened() const { return opened_cells; }
+
+    /**
+     * Returns the nodes taken from the frontier by the last call to step, in order.
+     */
+    const std::vector<int>& closed() const { return closed_cells; }
+
+    std::size_t frontier_size() const;
+
+    /**
+     * Calls f(idx) for every node in the frontier, in no particular order.
+     */
+    template <typename F>
+    void for_each_frontier(F&& f) const {
+        if (algorithm == Algorithm::Bfs || algorithm == Algorithm::Dfs) {
+            for (auto i = head; i < workspace.frontier.size(); ++i)
+                f(workspace.frontier[i]);
+            return;
+        }
+        workspace.heap.for_each([&f](int idx) { f(idx); });
+    }
+
+    /**
+     * Returns the distance of a node from the start, or SearchWorkspace::infinity if it was not
+     * reached yet.
+     */
+    int distance(int idx) const { return workspace.distance(idx); }
+
+    /**
+     * Returns the cells of the shortest path from start to end, empty unless found.
+     */
+    std::vector<int> path() const;
+
+    /**
+     * Returns the statistics so far. The wall time sums up the calls to step.
+     */
+    const SearchStats& stats() const { return search_stats; }
+};
+
+#endif  // MAZE_STEPPED_SEARCH_H
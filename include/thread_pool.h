@@ -0,0 +1,85 @@
+#ifndef MAZE_THREAD_POOL_H
+#define MAZE_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fork-join pool of worker threads. A job is run by every worker and the calling thread, and
+ * run returns once all of them finished it, so consecutive jobs act as barriers.
+ * Jobs must not throw.
+ */
+class ThreadPool {
+   private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;      /// Signals a new job or stop to the workers.
+    std::condition_variable finished;  /// Signals the calling thread that all workers are done.
+
+    const std::function<void(unsigned)>* job{};  /// Current job, valid while running > 0.
+    std::uint64_t epoch{};                       /// Number of jobs started so far.
+    unsigned running{};                          /// Workers that did not finish the current job yet.
+    bool stop{false};
+
+    void work(unsigned worker);
+
+   public:
+    /**
+     * Starts the worker threads.
+     *
+     * @param threads Number of threads including the calling thread, 0 for one per hardware thread.
+     */
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Returns the number of threads that run a job, including the calling thread.
+     */
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    /**
+     * Runs f(worker) on every thread and waits until all calls returned.
+     * The calling thread is worker 0.
+     */
+    void run(const std::function<void(unsigned worker)>& f);
+
+    /**
+     * Splits [0, n) into chunks of at most grain items, which the threads take one after another
+     * until none are left. Calls f(begin, end, worker) for every chunk. A single chunk is run on the
+     * calling thread without waking the workers.
+     *
+     * @param n Number of items.
+     * @param grain Number of items per chunk.
+     * @param f Called with the item range of a chunk and the id of the thread that runs it.
+     */
+    template <typename F>
+    void parallel_for(std::size_t n, std::size_t grain, F&& f) {
+        if (n <= grain || workers.empty()) {
+            if (n > 0)
+                f(std::size_t{0}, n, 0u);
+            return;
+        }
+
+        std::atomic<std::size_t> next{0};
+        run([&](unsigned worker) {
+            for (;;) {
+                auto const begin = next.fetch_add(grain, std::memory_order_relaxed);
+                if (begin >= n)
+                    break;
+                f(begin, std::min(n, begin + grain), worker);
+            }
+        });
+    }
+};
+
+#endif  // MAZE_THREAD_POOL_H
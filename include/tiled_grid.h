@@ -0,0 +1,154 @@
+#ifndef MAZE_TILED_GRID_H
+#define MAZE_TILED_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Activity of the tile cache of a TiledGrid.
+ */
+struct TileStats {
+    std::uint64_t hits{};        /// Cell accesses to a resident tile.
+    std::uint64_t faults{};      /// Cell accesses that had to read their tile from the file.
+    std::uint64_t evictions{};   /// Tiles dropped to stay within the memory budget.
+    std::uint64_t bytes_read{};  /// Bytes read from the file.
+};
+
+/**
+ * Read-only grid of a maze file that keeps only some of its tiles in memory, for mazes that do
+ * not fit into memory even bit-packed.
+ *
+ * The grid is split into square tiles, which are read from the file on first access. When the
+ * memory budget is used up, the least recently used tile is dropped. Cells are addressed with
+ * 64-bit indices, so the number of cells is not limited by int like in Grid.
+ */
+class TiledGrid {
+   public:
+    static constexpr int tile_size = 256;              /// Tiles cover tile_size x tile_size cells.
+    static constexpr int tile_words = tile_size / 64;  /// Number of 64-bit words per row of a tile.
+    static constexpr std::size_t tile_bytes = std::size_t{tile_size} * tile_words * sizeof(std::uint64_t);
+
+   private:
+    struct Tile {
+        std::uint64_t key;                 /// Tile row * tiles_per_row + tile column.
+        std::vector<std::uint64_t> words;  /// tile_size rows of tile_words words.
+    };
+
+    std::ifstream file;
+    std::int64_t w{};
+    std::int64_t h{};
+    std::int64_t words_per_row{};  /// Number of 64-bit words per row of the file.
+    std::int64_t plane_offset{};   /// Byte offset of the plane in the file.
+    std::int64_t tiles_per_row{};
+    std::uint64_t start_idx{};
+    std::uint64_t end_idx{};
+
+    std::size_t capacity;  /// Maximum number of resident tiles.
+    std::list<Tile> lru;   /// Resident tiles, the most recently used first.
+    std::unordered_map<std::uint64_t, std::list<Tile>::iterator> resident;
+    TileStats tile_stats;
+
+    /// Grids with rows of at most this many words read the whole band of rows of a tile at once.
+    static constexpr std::int64_t max_band_words = 16 * tile_words;
+    std::vector<std::uint64_t> band;  /// Rows of the last band read.
+
+    /**
+     * Returns the tile with the given key, which becomes the most recently used one.
+     */
+    const Tile& tile(std::uint64_t key);
+
+    /**
+     * Reads a tile from the file. Cells outside the grid are impassable.
+     */
+    void read(Tile& t);
+
+   public:
+    /**
+     * Opens a maze file written by maze_file::Writer or Maze::save.
+     *
+     * @param path Path of the maze file.
+     * @param memory_budget Maximum number of bytes of resident tiles, at least one tile is kept.
+     * @throws std::runtime_error if the file cannot be opened or is not a valid maze file.
+     */
+    TiledGrid(const std::string& path, std::size_t memory_budget);
+
+    std::int64_t width() const { return w; }
+    std::int64_t height() const { return h; }
+    std::uint64_t size() const { return static_cast<std::uint64_t>(w) * static_cast<std::uint64_t>(h); }
+
+    std::uint64_t index(std::int64_t x, std::int64_t y) const { return static_cast<std::uint64_t>(y * w + x); }
+    bool in_bounds(std::int64_t x, std::int64_t y) const { return x >= 0 && x < w && y >= 0 && y < h; }
+    std::int64_t x_of(std::uint64_t idx) const { return static_cast<std::int64_t>(idx % static_cast<std::uint64_t>(w)); }
+    std::int64_t y_of(std::uint64_t idx) const { return static_cast<std::int64_t>(idx / static_cast<std::uint64_t>(w)); }
+
+    /// Cell indices of the starting point and the end point stored in the file.
+    std::uint64_t start() const { return start_idx; }
+    std::uint64_t end() const { return end_idx; }
+
+    /**
+     * Returns the key of the tile that holds a cell. Tiles are numbered row by row.
+     */
+    std::uint64_t tile_of(std::uint64_t idx) const {
+        return static_cast<std::uint64_t>(y_of(idx) / tile_size * tiles_per_row + x_of(idx) / tile_size);
+    }
+
+    /**
+     * Returns the passability of a cell inside the grid, reading its tile if it is not resident.
+     */
+    bool passable(std::int64_t x, std::int64_t y) {
+        auto const& t = tile(static_cast<std::uint64_t>(y / tile_size * tiles_per_row + x / tile_size));
+        auto const col = x % tile_size;
+        return (t.words[(y % tile_size) * tile_words + (col >> 6)] >> (col & 63)) & 1u;
+    }
+
+    /**
+     * Returns true if (x, y) lies inside the grid and is passable.
+     */
+    bool open(std::int64_t x, std::int64_t y) { return in_bounds(x, y) && passable(x, y); }
+
+    /**
+     * Calls f(neighbor_idx) for every passable neighbor of the cell idx, in the same order as
+     * Grid::for_each_neighbor.
+     */
+    template <typename F>
+    void for_each_neighbor(std::uint64_t idx, F&& f) {
+        auto const x = x_of(idx);
+        auto const y = y_of(idx);
+
+        if (open(x - 1, y))
+            f(idx - 1);
+        if (open(x + 1, y))
+            f(idx + 1);
+        if (open(x, y - 1))
+            f(idx - static_cast<std::uint64_t>(w));
+        if (open(x, y + 1))
+            f(idx + static_cast<std::uint64_t>(w));
+
+        if constexpr (diagonal_movement) {
+            if (open(x - 1, y - 1))
+                f(idx - static_cast<std::uint64_t>(w) - 1);
+            if (open(x + 1, y - 1))
+                f(idx - static_cast<std::uint64_t>(w) + 1);
+            if (open(x - 1, y + 1))
+                f(idx + static_cast<std::uint64_t>(w) - 1);
+            if (open(x + 1, y + 1))
+                f(idx + static_cast<std::uint64_t>(w) + 1);
+        }
+    }
+
+    const TileStats& stats() const { return tile_stats; }
+
+    /**
+     * Returns the number of tiles in memory.
+     */
+    std::size_t resident_tiles() const { return lru.size(); }
+};
+
+#endif  // MAZE_TILED_GRID_H
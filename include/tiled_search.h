@@ -0,0 +1,44 @@
+#ifndef MAZE_TILED_SEARCH_H
+#define MAZE_TILED_SEARCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "search_stats.h"
+#include "tiled_grid.h"
+
+/**
+ * Searches on a TiledGrid. The bookkeeping is kept in hash maps of the reached cells instead of
+ * arrays over all cells, so it only grows with the part of the maze a search explores.
+ */
+namespace tiled {
+
+/**
+ * Result of a search on a TiledGrid.
+ */
+struct Result {
+    std::vector<std::uint64_t> path;  /// Cells from the start to the end, empty if the end is not reachable.
+    SearchStats stats;                /// Counters of the search, path_cost is -1 if the end is not reachable.
+    TileStats tiles;                  /// Activity of the tile cache during the search.
+};
+
+/**
+ * Shortest path by breadth-first search, computed one tile at a time.
+ *
+ * Cells reached from another tile wait until their tile is expanded, which happens in order of
+ * the smallest waiting distance. Inside a tile the cells are expanded in order of distance. A cell
+ * reached again on a shorter path is expanded again, so the distances are exact although the tiles
+ * are not expanded strictly level by level. Each tile is read once per visit instead of once per
+ * level, which keeps the tile faults low when the frontier spans more tiles than the budget.
+ */
+Result bfs(TiledGrid& grid, std::uint64_t start, std::uint64_t end);
+
+/**
+ * A* with the exact distance on an empty grid as heuristics. Nodes with the same f_score are
+ * expanded closest to the end first and then grouped by tile.
+ */
+Result a_star(TiledGrid& grid, std::uint64_t start, std::uint64_t end);
+
+}  // namespace tiled
+
+#endif  // MAZE_TILED_SEARCH_H
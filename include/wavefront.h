@@ -0,0 +1,126 @@
+#ifndef MAZE_WAVEFRONT_H
+#define MAZE_WAVEFRONT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Bit-parallel breadth first search on the passability plane of a Grid.
+ *
+ * The frontier is a bitmap with the layout of the plane. The next level is the frontier shifted
+ * by one cell in every direction, masked with the passable and not yet visited cells, so one
+ * 64-bit word, or one SSE or AVX2 register, advances 64, 128 or 256 cells at once. A second bitmap
+ * with one bit per word marks the words of the frontier, and only the words next to them are
+ * processed.
+ *
+ * Instead of a predecessor per cell, the level of every visited cell is kept modulo 3 in two
+ * bitmaps. The neighbors of a cell on level d are on levels d - 1, d or d + 1, so a shortest path
+ * is found by walking back from the end to a neighbor on the level before.
+ *
+ * The buffers are kept between searches, so repeated searches on one maze do not allocate.
+ */
+class Wavefront {
+   public:
+    enum class Kernel {
+        Scalar,  /// One 64-bit word at a time, works everywhere.
+        Sse2,    /// Two words at a time, x86 only.
+        Avx2,    /// Four words at a time, x86 only.
+    };
+
+    /**
+     * Returns true if the CPU supports the kernel.
+     */
+    static bool supported(Kernel kernel);
+
+    /**
+     * Returns the widest kernel the CPU supports.
+     */
+    static Kernel best_kernel();
+
+   private:
+    Kernel kernel{best_kernel()};
+
+    int w{};
+    int h{};
+    int stride{};  /// Number of 64-bit words per row of the grid.
+    int pitch{};   /// Number of words per row of the bitmaps, with a zero word on either side.
+
+    // Bitmaps with a zero row above and below the grid and pitch words per row.
+    std::vector<std::uint64_t> frontier;  /// Cells of the current level.
+    std::vector<std::uint64_t> next;      /// Cells of the next level.
+    std::vector<std::uint64_t> visited;   /// Cells of every level so far.
+    std::vector<std::uint64_t> low;       /// Low bit of the level modulo 3 of the visited cells.
+    std::vector<std::uint64_t> high;      /// High bit of the level modulo 3 of the visited cells.
+
+    int summary_stride{};  /// Number of words per row of the summaries.
+    int summary_pitch{};   /// Number of words per row of the summaries, with a zero word on either side.
+
+    // Summaries with a bit per word of the bitmaps, set for the words with a cell, laid out like
+    // the bitmaps.
+    std::vector<std::uint64_t> summary;       /// Words of the frontier.
+    std::vector<std::uint64_t> next_summary;  /// Words of the next level.
+
+    std::vector<int> active;           /// Rows with a cell in the frontier.
+    std::vector<int> next_active;      /// Rows with a cell in the next level.
+    std::vector<int> rows;             /// Rows processed for the next level.
+    std::vector<std::uint64_t> queued;  /// One bit per row, set for the rows of the next level.
+
+    std::size_t levels{};  /// Number of levels expanded by the last search.
+
+    /**
+     * Resizes the bitmaps for the grid and clears them.
+     */
+    void prepare(const Grid& grid);
+
+    std::uint64_t* summary_row(std::vector<std::uint64_t>& bits, int y) {
+        return bits.data() + (y + 1) * summary_pitch + 1;
+    }
+
+    std::uint64_t* row(std::vector<std::uint64_t>& bits, int y) { return bits.data() + (y + 1) * pitch + 1; }
+
+    bool bit(const std::vector<std::uint64_t>& bits, int idx) const {
+        auto const x = idx % w;
+        auto const word = bits[static_cast<std::size_t>((idx / w + 1) * pitch + 1 + (x >> 6))];
+        return (word >> (x & 63)) & 1u;
+    }
+
+    /**
+     * Returns the level modulo 3 of a visited cell.
+     */
+    int level_mod3(int idx) const { return static_cast<int>(bit(low, idx)) | static_cast<int>(bit(high, idx)) << 1; }
+
+   public:
+    /**
+     * Selects the kernel of the following searches.
+     *
+     * @throws std::runtime_error if the CPU does not support it.
+     */
+    void set_kernel(Kernel k);
+
+    Kernel get_kernel() const { return kernel; }
+
+    /**
+     * Searches from start until the level containing end is reached or every reachable cell was
+     * visited.
+     *
+     * @param path If not null, receives the cells of a shortest path from start to end, or is
+     *             cleared if the end is not reachable. The levels are only recorded if it is set.
+     * @return The distance from start to end, -1 if the end is not reachable.
+     */
+    int run(const Grid& grid, int start, int end, std::vector<int>* path = nullptr);
+
+    /**
+     * Returns the number of cells visited by the last search.
+     */
+    std::size_t visited_count() const;
+
+    /**
+     * Returns the number of levels expanded by the last search.
+     */
+    std::size_t level_count() const { return levels; }
+};
+
+#endif  // MAZE_WAVEFRONT_H
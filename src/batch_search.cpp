@@ -0,0 +1,98 @@
+#include "batch_search.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "grid_metrics.h"
+
+namespace {
+
+/// Queries per chunk. Small, because the queries of a batch can differ a lot in cost.
+constexpr std::size_t query_grain = 8;
+
+/**
+ * Finds the shortest path from start to end with A* and appends it to out.
+ *
+ * @return The number of appended cells, 0 if the end is not reachable.
+ */
+std::size_t a_star(const Grid& grid, SearchWorkspace& workspace, int start, int end, std::vector<std::uint32_t>& out) {
+    if (start < 0 || end < 0 || start >= grid.size() || end >= grid.size() || !grid.passable(start) ||
+        !grid.passable(end))
+        return 0;
+
+    workspace.reset();
+    auto& pq = workspace.heap;
+
+    auto const end_x = grid.x_of(end);
+    auto const end_y = grid.y_of(end);
+    auto const h = [&grid, end_x, end_y](int idx) {
+        return grid_distance(grid.x_of(idx) - end_x, grid.y_of(idx) - end_y);
+    };
+
+    // Ties of f_score are broken in favor of the larger g_score, like Maze::a_star.
+    workspace.visit(start, 0, start);
+    pq.push(h(start), start);
+
+    while (!pq.empty()) {
+        auto const cur = pq.pop().second;
+        if (cur == end)
+            break;
+
+        auto const g = workspace.distance(cur) + 1;
+        grid.for_each_neighbor(cur, [&](int n) {
+            if (g < workspace.distance(n)) {
+                workspace.visit(n, g, cur);
+                pq.push(g + h(n), n, -g);
+            }
+        });
+    }
+
+    if (!workspace.visited(end))
+        return 0;
+
+    // Append the path from the end and reverse it in place.
+    auto const first = out.size();
+    auto cur = end;
+    out.push_back(static_cast<std::uint32_t>(cur));
+    while (cur != workspace.parent_of(cur)) {
+        cur = workspace.parent_of(cur);
+        out.push_back(static_cast<std::uint32_t>(cur));
+    }
+    std::reverse(out.begin() + static_cast<std::ptrdiff_t>(first), out.end());
+
+    return out.size() - first;
+}
+
+}  // namespace
+
+PathBatch BatchSearch::run(const Grid& grid, ThreadPool& pool, const std::vector<Query>& queries) {
+    if (workspaces.size() < pool.size())
+        workspaces.resize(pool.size());
+    for (auto& workspace : workspaces)
+        workspace.prepare(grid.size());
+
+    auto const count = (queries.size() + query_grain - 1) / query_grain;
+    if (chunks.size() < count)
+        chunks.resize(count);
+    sizes.resize(queries.size());
+
+    pool.parallel_for(queries.size(), query_grain, [&](std::size_t begin, std::size_t end, unsigned worker) {
+        auto& out = chunks[begin / query_grain];
+        out.clear();
+
+        for (auto i = begin; i < end; ++i)
+            sizes[i] = a_star(grid, workspaces[worker], queries[i].start, queries[i].end, out);
+    });
+
+    // The chunks hold consecutive queries, so concatenating them keeps the input order.
+    PathBatch res;
+    res.offsets.resize(queries.size() + 1);
+    for (std::size_t i = 0; i < queries.size(); ++i)
+        res.offsets[i + 1] = res.offsets[i] + sizes[i];
+
+    res.cells.reserve(res.offsets.back());
+    for (std::size_t c = 0; c < count; ++c)
+        res.cells.insert(res.cells.end(), chunks[c].begin(), chunks[c].end());
+
+    return res;
+}
@@ -0,0 +1,34 @@
+#include "bucket_queue.h"
+
+void BucketQueue::reset(int span) {
+    assert(span >= 0);
+
+    auto size = std::size_t{1};
+    while (size <= static_cast<std::size_t>(span))
+        size <<= 1;
+
+    if (buckets.size() < size)
+        buckets.resize(size);
+    for (auto& b : buckets)
+        b.clear();
+
+    mask = size - 1;
+    cursor = 0;
+    count = 0;
+    started = false;
+}
+
+std::pair<int, int> BucketQueue::pop() {
+    assert(count > 0);
+
+    // Skip empty buckets, there are at most span of them.
+    while (buckets[static_cast<std::size_t>(cursor) & mask].empty())
+        ++cursor;
+
+    auto& bucket = buckets[static_cast<std::size_t>(cursor) & mask];
+    auto const idx = bucket.back();
+    bucket.pop_back();
+    --count;
+
+    return {cursor, idx};
+}
@@ -0,0 +1,112 @@
+#include "component_index.h"
+
+#include <array>
+#include <numeric>
+#include <utility>
+
+#include "grid_metrics.h"
+
+namespace {
+
+struct Offset {
+    int dx;
+    int dy;
+};
+
+/// The eight cells around a cell in cyclic order. Consecutive cells are neighbors with and without
+/// diagonal movement.
+constexpr std::array<Offset, 8> ring{{
+    {-1, -1},
+    {0, -1},
+    {1, -1},
+    {1, 0},
+    {1, 1},
+    {0, 1},
+    {-1, 1},
+    {-1, 0},
+}};
+
+/**
+ * Returns true if the passable neighbors of (x, y) are connected to each other through the cells
+ * around (x, y). Then blocking (x, y) does not split its component, because every path through it
+ * can go around it instead.
+ */
+bool connected_around(const Grid& grid, int x, int y) {
+    std::array<bool, ring.size()> open{};
+    for (std::size_t i = 0; i < ring.size(); ++i)
+        open[i] = grid.open(x + ring[i].dx, y + ring[i].dy);
+
+    // Count the runs of consecutive passable cells that hold a neighbor of (x, y). Without
+    // diagonal movement, the corners only connect two sides but are no neighbors themselves.
+    auto runs = 0;
+    for (std::size_t i = 0; i < ring.size(); ++i) {
+        if (!open[i] || open[(i + ring.size() - 1) % ring.size()])
+            continue;
+
+        // The run ends because the cell before it is impassable.
+        auto neighbor = false;
+        for (auto j = i; open[j % ring.size()]; ++j) {
+            auto const [dx, dy] = ring[j % ring.size()];
+            neighbor |= diagonal_movement || dx == 0 || dy == 0;
+        }
+        runs += neighbor;
+    }
+
+    // If every cell around is passable, no run starts and runs is 0.
+    return runs <= 1;
+}
+
+}  // namespace
+
+int ComponentIndex::find(int idx) {
+    return find_root(parent, idx);
+}
+
+void ComponentIndex::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b)
+        return;
+
+    if (size[a] < size[b])
+        std::swap(a, b);
+    parent[b] = a;
+    size[a] += size[b];
+}
+
+void ComponentIndex::build(const Grid& grid) {
+    parent.resize(grid.size());
+    size.assign(grid.size(), 1);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    // Every edge is seen from both ends, uniting once is enough.
+    for (auto idx = 0; idx < grid.size(); ++idx) {
+        if (!grid.passable(idx))
+            continue;
+        grid.for_each_neighbor(idx, [this, idx](int n) {
+            if (n > idx)
+                unite(idx, n);
+        });
+    }
+
+    dirty = false;
+}
+
+void ComponentIndex::open(const Grid& grid, int idx) {
+    if (dirty)
+        return;
+    grid.for_each_neighbor(idx, [this, idx](int n) { unite(idx, n); });
+}
+
+void ComponentIndex::close(const Grid& grid, int idx) {
+    if (!dirty && !connected_around(grid, grid.x_of(idx), grid.y_of(idx)))
+        dirty = true;
+}
+
+bool ComponentIndex::connected(const Grid& grid, int a, int b) {
+    if (!grid.passable(a) || !grid.passable(b))
+        return false;
+    if (dirty)
+        build(grid);
+    return find(a) == find(b);
+}
@@ -0,0 +1,175 @@
+#include "d_star_lite.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "grid_metrics.h"
+
+namespace {
+
+constexpr int infinity = std::numeric_limits<int>::max();
+
+/// Queue more changed cells than cells / max_changes and the state is rebuilt instead of repaired.
+constexpr int max_changes = 16;
+
+/**
+ * Calls f(neighbor_idx) for every neighbor of the cell idx inside the grid, passable or not.
+ */
+template <typename F>
+void for_each_cell_around(const Grid& grid, int idx, F&& f) {
+    auto const x = grid.x_of(idx);
+    auto const y = grid.y_of(idx);
+
+    for (auto dy = -1; dy <= 1; ++dy) {
+        for (auto dx = -1; dx <= 1; ++dx) {
+            if ((dx == 0 && dy == 0) || (!diagonal_movement && dx != 0 && dy != 0))
+                continue;
+            if (grid.in_bounds(x + dx, y + dy))
+                f(grid.index(x + dx, y + dy));
+        }
+    }
+}
+
+/**
+ * Returns the distance of two cells on an empty grid, which never overestimates.
+ */
+int heuristic(const Grid& grid, int a, int b) {
+    return grid_distance(grid.x_of(a) - grid.x_of(b), grid.y_of(a) - grid.y_of(b));
+}
+
+}  // namespace
+
+std::pair<int, int> DStarLite::key(const Grid& grid, int idx) const {
+    auto const m = std::min(g[idx], rhs[idx]);
+    if (m == infinity)
+        return {infinity, infinity};
+    return {m + heuristic(grid, start, idx) + km, m};
+}
+
+void DStarLite::update_vertex(const Grid& grid, int idx, SearchStats& stats) {
+    if (idx == goal) {
+        rhs[idx] = grid.passable(idx) ? 0 : infinity;
+    } else {
+        // Edges to and from impassable cells cost infinity.
+        auto best = infinity;
+        if (grid.passable(idx)) {
+            grid.for_each_neighbor(idx, [this, &best](int n) {
+                if (g[n] != infinity)
+                    best = std::min(best, g[n] + 1);
+            });
+        }
+        rhs[idx] = best;
+    }
+
+    if (g[idx] != rhs[idx]) {
+        auto const [k1, k2] = key(grid, idx);
+        stats.generated += !open.contains(idx);
+        open.update(k1, idx, k2);
+        ++stats.pushes;
+    } else {
+        open.remove(idx);
+    }
+}
+
+void DStarLite::compute_shortest_path(const Grid& grid, SearchTrace& trace) {
+    auto& stats = trace.stats();
+
+    while (!open.empty()) {
+        stats.peak_frontier = std::max(stats.peak_frontier, open.size());
+
+        auto const top = std::make_pair(open.top().first, open.top_tie());
+        if (!(top < key(grid, start)) && rhs[start] == g[start])
+            break;
+
+        auto const cur = open.top().second;
+        ++stats.pops;
+
+        // The key is out of date if the start moved since the cell was queued.
+        auto const current = key(grid, cur);
+        if (top < current) {
+            open.update(current.first, cur, current.second);
+            continue;
+        }
+
+        trace.add_visited(cur);
+        ++stats.expanded;
+
+        if (g[cur] > rhs[cur]) {
+            // Overconsistent: the cell got closer to the goal, which its neighbors may use.
+            g[cur] = rhs[cur];
+            open.remove(cur);
+            grid.for_each_neighbor(cur, [&](int n) { update_vertex(grid, n, stats); });
+        } else {
+            // Underconsistent: the cell got farther away, so it and its neighbors are recomputed.
+            g[cur] = infinity;
+            update_vertex(grid, cur, stats);
+            grid.for_each_neighbor(cur, [&](int n) { update_vertex(grid, n, stats); });
+        }
+    }
+}
+
+void DStarLite::invalidate(int idx) {
+    if (cells == 0)
+        return;
+
+    changed.push_back(idx);
+    if (static_cast<int>(changed.size()) > cells / max_changes)
+        reset();
+}
+
+void DStarLite::reset() {
+    cells = 0;
+    changed.clear();
+}
+
+int DStarLite::plan(const Grid& grid, int start_idx, int goal_idx, SearchTrace& trace) {
+    auto& stats = trace.stats();
+
+    if (cells != grid.size() || goal != goal_idx) {
+        // Start over: only the goal is consistent.
+        cells = grid.size();
+        goal = goal_idx;
+        start = start_idx;
+        km = 0;
+        changed.clear();
+
+        g.assign(cells, infinity);
+        rhs.assign(cells, infinity);
+        open.prepare(cells);
+        open.clear();
+        update_vertex(grid, goal, stats);
+    } else {
+        // The keys of the queued cells stay valid lower bounds if km grows by the distance the start moved.
+        if (start_idx != start) {
+            km += heuristic(grid, start, start_idx);
+            start = start_idx;
+        }
+
+        // The edges of a changed cell changed, which affects its rhs and the rhs of its neighbors.
+        for (auto const idx : changed) {
+            update_vertex(grid, idx, stats);
+            for_each_cell_around(grid, idx, [&](int n) { update_vertex(grid, n, stats); });
+        }
+        changed.clear();
+    }
+
+    compute_shortest_path(grid, trace);
+
+    if (g[start] == infinity || !grid.passable(start))
+        return -1;
+
+    // Walk down the distances from the start to the goal.
+    auto cur = start;
+    trace.add_path(cur);
+    while (cur != goal) {
+        auto next = -1;
+        grid.for_each_neighbor(cur, [this, &next](int n) {
+            if (g[n] != infinity && (next < 0 || g[n] < g[next]))
+                next = n;
+        });
+        cur = next;
+        trace.add_path(cur);
+    }
+
+    return g[start];
+}
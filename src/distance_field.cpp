@@ -0,0 +1,86 @@
+#include "distance_field.h"
+
+#include <array>
+
+namespace {
+
+// Offsets of the directions, in the neighbor order of Grid::for_each_neighbor.
+constexpr std::array<int, 8> dx{-1, 1, 0, 0, -1, 1, -1, 1};
+constexpr std::array<int, 8> dy{0, 0, -1, 1, -1, -1, 1, 1};
+
+/**
+ * Returns the direction from a cell to its neighbor at the offset (x, y).
+ */
+std::uint8_t direction_of(int x, int y) {
+    // Indexed by (y + 1) * 3 + (x + 1), the center has no direction.
+    constexpr std::array<std::uint8_t, 9> directions{4, 2, 5, 0, DistanceField::no_direction, 1, 6, 3, 7};
+    return directions[static_cast<std::size_t>((y + 1) * 3 + (x + 1))];
+}
+
+}  // namespace
+
+void DistanceField::compute(const Grid& grid, const std::vector<int>& goals, bool with_directions) {
+    w = grid.width();
+    h = grid.height();
+    auto const size = static_cast<std::size_t>(grid.size());
+    distances.assign(size, unreachable);
+    if (with_directions)
+        directions.assign(size, no_direction);
+    else
+        directions.clear();
+
+    // Every goal starts the search at distance 0, so each cell gets the distance to its nearest goal.
+    queue.clear();
+    for (auto const goal : goals) {
+        if (goal < 0 || goal >= grid.size() || !grid.passable(goal) || distances[static_cast<std::size_t>(goal)] == 0)
+            continue;
+        distances[static_cast<std::size_t>(goal)] = 0;
+        queue.push_back(goal);
+    }
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        auto const cur = queue[head];
+        auto const d = distances[static_cast<std::size_t>(cur)] + 1;
+        grid.for_each_neighbor(cur, [&](int n) {
+            auto& distance = distances[static_cast<std::size_t>(n)];
+            if (distance != unreachable)
+                return;
+            distance = d;
+            if (with_directions)
+                directions[static_cast<std::size_t>(n)] = direction_of(grid.x_of(cur) - grid.x_of(n), grid.y_of(cur) - grid.y_of(n));
+            queue.push_back(n);
+        });
+    }
+
+    reached_cells = queue.size();
+    farthest = queue.empty() ? unreachable : distances[static_cast<std::size_t>(queue.back())];
+}
+
+int DistanceField::next(const Grid& grid, int idx) const {
+    auto const d = distance(idx);
+    if (d <= 0)
+        return -1;
+
+    if (has_directions()) {
+        auto const dir = direction(idx);
+        return grid.index(grid.x_of(idx) + dx[dir], grid.y_of(idx) + dy[dir]);
+    }
+
+    auto res = -1;
+    grid.for_each_neighbor(idx, [&](int n) {
+        if (res < 0 && distance(n) == d - 1)
+            res = n;
+    });
+    return res;
+}
+
+std::vector<int> DistanceField::path(const Grid& grid, int idx) const {
+    std::vector<int> res;
+    if (distance(idx) == unreachable)
+        return res;
+
+    res.reserve(static_cast<std::size_t>(distance(idx)) + 1);
+    for (auto cur = idx; cur >= 0; cur = next(grid, cur))
+        res.push_back(cur);
+    return res;
+}
@@ -1,48 +1,158 @@
 #include "engine.h"
 
+#include <algorithm>
+#include <cmath>
+#include <random>
 #include <stdexcept>
+#include <utility>
 
 #include "fmt/core.h"
 
-Engine::Engine(bool random, int width, int height, int prob)
-    : maze(random, width, height, prob),
+Engine::Engine(bool random, int width, int height, int prob, RenderMode render_mode)
+    : mode{render_mode},
+      maze(random, width, height, prob),
       r{random},
       w{width},
       h{height},
       p{prob} {
-    auto const window_w = w * (scale + border_size * 2) + 2 * border_size + 2 * scale;
-    auto const hindow_h = h * (scale + border_size * 2) + 2 * border_size + 2 * scale + top_margin;
+    // The window fits the maze, but not beyond the screen. The camera shows the rest.
+    auto window_w = static_cast<unsigned>(w * cell_size + 2 * border_size + 2 * scale);
+    auto hindow_h = static_cast<unsigned>(h * cell_size + 2 * border_size + 2 * scale + top_margin);
+    auto const desktop = sf::VideoMode::getDesktopMode();
+    if (desktop.width > 0 && desktop.height > 0) {
+        window_w = std::min(window_w, desktop.width * 9 / 10);
+        hindow_h = std::min(hindow_h, desktop.height * 9 / 10);
+    }
 
     window.create(sf::VideoMode(window_w, hindow_h), "maze");
 
     if (!font.loadFromFile("font/SourceSansPro-Regular.otf")) {
         throw std::runtime_error("Failed to open font");
     }
+
+    if (mode == RenderMode::Auto)
+        mode = w * h <= max_quad_cells ? RenderMode::Quads : RenderMode::Texture;
+    auto const cells = static_cast<std::size_t>(w) * static_cast<std::size_t>(h);
+    marks.assign(cells, Mark::None);
+    pixels.assign(cells * 4, 0);
+    ranks.assign(cells, 0);
+    steps_per_frame = std::max(1, w * h / animation_frames);
+
+    if (mode == RenderMode::Quads)
+        build_vertices();
+    else
+        build_texture();
+    build_levels();
+    reset_camera();
+    attach_observer();
+}
+
+namespace {
+
+void print_stats(const char*, const SearchStats& stats) {
+    if (stats.path_cost < 0) {
+        fmt::print("The end is not reachable, {} nodes were expanded.\n", stats.expanded);
+        return;
+    }
+    fmt::print("It took {:.3f}ms to find the end, {} nodes were expanded.\n", stats.wall_time_ns / 1e6, stats.expanded);
+}
+
+}  // namespace
+
+void Engine::attach_observer() {
+    maze.set_observer(print_stats);
 }
 
 void Engine::reset() {
-    visited.clear();
-    sp.clear();
+    worker.cancel();
+    stepper.reset();
+    trace.clear();
     counter_visited = 0;
     counter_sp = 0;
     finish = false;
     go = false;
+
+    std::fill(marks.begin(), marks.end(), Mark::None);
+    current = -1;
+    all_dirty = true;
+}
+
+void Engine::start_search(SearchWorker::Search search) {
+    trace.clear();
+    worker.start(maze, std::move(search));
+}
+
+void Engine::collect_search() {
+    if (!worker.busy())
+        return;
+
+    // Whatever is drained after the worker finished is the rest of the search.
+    auto const finished = worker.finished();
+    worker.drain([this](int idx, bool backward) { trace.add_visited(idx, backward); });
+    if (!finished)
+        return;
+
+    auto result = worker.take();
+    for (std::size_t i = 0; i < result.path_size(); ++i)
+        trace.add_path(result.path(i));
+    trace.stats() = result.stats();
+}
+
+void Engine::start_stepped_search(SteppedSearch::Algorithm search, Heuristics heuristic) {
+    trace.clear();
+    stepper = std::make_unique<SteppedSearch>(maze, search, heuristic);
+}
+
+void Engine::advance_search() {
+    if (!stepper || stepper->done())
+        return;
+
+    stepper->step(static_cast<std::size_t>(steps_per_frame), step_budget);
+    for (auto const idx : stepper->opened()) {
+        marks[static_cast<std::size_t>(idx)] = Mark::Open;
+        mark_dirty(idx);
+    }
+    for (auto const idx : stepper->closed()) {
+        marks[static_cast<std::size_t>(idx)] = Mark::Visited;
+        mark_dirty(idx);
+    }
+    if (stepper->current() != current) {
+        if (current >= 0)
+            mark_dirty(current);
+        current = stepper->current();
+        mark_dirty(current);
+    }
+
+    // The statistics are shown while the search runs, the path once it is done.
+    counter_visited = stepper->stats().pops;
+    trace.stats() = stepper->stats();
+    if (!stepper->done())
+        return;
+
+    for (auto const idx : stepper->path())
+        trace.add_path(idx);
+    finish = true;
+    print_stats(algorithm.c_str(), trace.stats());
+}
+
+void Engine::invalidate() {
+    all_dirty = true;
+    field_dirty = true;
 }
 
 void Engine::run() {
     while (window.isOpen()) {
-        vertices.clear();
         handle_keyboard_input();
         handle_mouse_input();
-        window.clear(color_bg);
+        collect_search();
+        advance_search();
+        for (auto i = 0; i < steps_per_frame; ++i)
+            advance_animation();
+        update_cells();
 
+        window.clear(color_bg);
+        draw_cells();
         draw_text();
-        draw_background_vertex_array();
-        draw_visited_vertex_array();
-        draw_shorest_path_vertex_array();
-        draw_current_node_vertex_array();
-
-        window.draw(&vertices[0], vertices.size(), sf::Quads);
         window.display();
     }
 }
@@ -52,34 +162,46 @@ void Engine::run() {
 /////////////////////////////////////////////////////////////////
 
 void Engine::handle_mouse_input() {
-    // Get current mouse position
-    auto mouse_pos = sf::Mouse::getPosition(window);
-
-    auto x_pos = (mouse_pos.x + scale) / (scale + border_size * 2) - 2;
-    auto y_pos = (mouse_pos.y - scale - top_margin) / (scale + border_size * 2);
+    // The maze must not change while a search runs on it.
+    if (worker.busy() || (stepper && !stepper->done()))
+        return;
 
-    // Check if the position is inside the 2D vector.
-    auto out_of_bound = !(x_pos >= 0 && x_pos < w && y_pos >= 0 && y_pos < h);
-    if (out_of_bound)
+    // Get the cell under the mouse through the camera.
+    auto const idx = cell_at(sf::Mouse::getPosition(window));
+    if (idx < 0)
         return;
+    auto const x_pos = idx % w;
+    auto const y_pos = idx / w;
 
     // Check if the position is a starting or end point.
-    auto start_or_end = maze.maze[x_pos][y_pos].start || maze.maze[x_pos][y_pos].end;
+    auto const node = maze.get_node(x_pos, y_pos);
+    auto start_or_end = node.start || node.end;
     if (start_or_end)
         return;
 
+    // Only the edited cells and the previous start or end have to be recolored, unless the
+    // distances of the heatmap change. Every edit can change them: a new start or end is made
+    // passable, which may open a wall.
     if (sf::Mouse::isButtonPressed(sf::Mouse::Left)) {
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) {
+            mark_dirty(maze.get_start().id);
             maze.set_start(x_pos, y_pos);
-        else
-            maze.maze[x_pos][y_pos].passable = false;
+        } else {
+            maze.set_passable(x_pos, y_pos, false);
+        }
+        field_dirty = true;
+        mark_dirty(node.id);
     }
 
     if (sf::Mouse::isButtonPressed(sf::Mouse::Right)) {
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) {
+            mark_dirty(maze.get_end().id);
             maze.set_end(x_pos, y_pos);
-        else
-            maze.maze[x_pos][y_pos].passable = true;
+        } else {
+            maze.set_passable(x_pos, y_pos, true);
+        }
+        field_dirty = true;
+        mark_dirty(node.id);
     }
 }
 
@@ -88,6 +210,13 @@ void Engine::handle_keyboard_input() {
     while (window.pollEvent(event)) {
         if (event.type == sf::Event::Closed)
             window.close();
+        handle_camera_input(event);
+
+        // Toggled once per key press instead of every frame the key is held.
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F) {
+            show_field = !show_field;
+            all_dirty = true;
+        }
     }
 
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Return))
@@ -96,132 +225,585 @@ void Engine::handle_keyboard_input() {
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::N)) {
         reset();
         maze = Maze(r, w, h, p);
+        attach_observer();
+        invalidate();
+    }
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::M)) {
+        reset();
+        maze = Maze::generate(generators::Algorithm::Eller, w, h, std::random_device{}());
+        attach_observer();
+        invalidate();
     }
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape))
         window.close();
+    pan_camera();
 
     if (go)
         return;
 
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num1)) {
-        fmt::print("Selected BFS.. ");
-        algorithm = "BFS";
-        visited = maze.bfs();
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift)) {
+            fmt::print("Selected Parallel BFS.. ");
+            algorithm = "Parallel BFS";
+            start_search([](Maze& m) { return m.parallel_bfs(); });
+        } else {
+            fmt::print("Selected BFS.. ");
+            algorithm = "BFS";
+            start_stepped_search(SteppedSearch::Algorithm::Bfs);
+        }
         go = true;
     }
 
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num2)) {
         fmt::print("Selected DFS.. ");
         algorithm = "DFS";
-        visited = maze.dfs();
+        start_stepped_search(SteppedSearch::Algorithm::Dfs);
         go = true;
     }
 
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num3)) {
         fmt::print("Selected Dijkstra.. ");
         algorithm = "Dijkstra";
-        auto res = maze.dijkstra();
-        visited = res.first;
-        sp = res.second;
+        start_stepped_search(SteppedSearch::Algorithm::Dijkstra);
         go = true;
     }
 
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num4)) {
         fmt::print("Selected A* with Manhattan.. ");
         algorithm = "A*";
-        auto res = maze.a_star(Heuristics::Manhattan);
-        visited = res.first;
-        sp = res.second;
+        start_stepped_search(SteppedSearch::Algorithm::AStar, Heuristics::Manhattan);
         go = true;
     }
 
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num5)) {
         fmt::print("Selected A* with Euclidean.. ");
         algorithm = "A*";
-        auto res = maze.a_star(Heuristics::Euclidean);
-        visited = res.first;
-        sp = res.second;
+        start_stepped_search(SteppedSearch::Algorithm::AStar, Heuristics::Euclidean);
+        go = true;
+    }
+
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num6)) {
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift)) {
+            fmt::print("Selected Bidirectional BFS.. ");
+            algorithm = "Bidirectional BFS";
+            start_search([](Maze& m) { return m.bidirectional_bfs(); });
+        } else {
+            fmt::print("Selected Bidirectional A*.. ");
+            algorithm = "Bidirectional A*";
+            start_search([](Maze& m) { return m.bidirectional_a_star(); });
+        }
+        go = true;
+    }
+
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num7)) {
+        fmt::print("Selected JPS.. ");
+        algorithm = "JPS";
+        start_search([](Maze& m) { return m.jps(); });
+        go = true;
+    }
+
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num8)) {
+        fmt::print("Selected JPS+.. ");
+        algorithm = "JPS+";
+        start_search([](Maze& m) { return m.jps_plus(); });
+        go = true;
+    }
+
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num9)) {
+        fmt::print("Selected HPA*.. ");
+        algorithm = "HPA*";
+        start_search([](Maze& m) { return m.hpa_star(); });
+        go = true;
+    }
+
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num0)) {
+        fmt::print("Selected D* Lite.. ");
+        algorithm = "D* Lite";
+        start_search([](Maze& m) { return m.d_star_lite(); });
         go = true;
     }
 
     if (sf::Keyboard::isKeyPressed(sf::Keyboard::C)) {
         maze.clear_maze();
+        invalidate();
     }
 }
 
+void Engine::handle_camera_input(const sf::Event& event) {
+    auto const center = sf::Vector2i(static_cast<int>(window.getSize().x / 2),
+                                     static_cast<int>(top_margin + (window.getSize().y - top_margin) / 2));
+
+    if (event.type == sf::Event::MouseWheelScrolled)
+        zoom_camera(event.mouseWheelScroll.delta > 0 ? 1 / zoom_step : zoom_step,
+                    sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y));
+    if (event.type == sf::Event::Resized)
+        reset_camera();
+    if (event.type != sf::Event::KeyPressed)
+        return;
+
+    if (event.key.code == sf::Keyboard::Add || event.key.code == sf::Keyboard::Equal)
+        zoom_camera(1 / zoom_step, center);
+    if (event.key.code == sf::Keyboard::Subtract || event.key.code == sf::Keyboard::Hyphen)
+        zoom_camera(zoom_step, center);
+    if (event.key.code == sf::Keyboard::H)
+        reset_camera();
+}
+
+void Engine::pan_camera() {
+    auto const size = camera.getSize();
+    auto dx = 0.f;
+    auto dy = 0.f;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left))
+        dx -= size.x * pan_step;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right))
+        dx += size.x * pan_step;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up))
+        dy -= size.y * pan_step;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down))
+        dy += size.y * pan_step;
+    camera.move(dx, dy);
+}
+
+void Engine::zoom_camera(float factor, sf::Vector2i pixel) {
+    auto const size = camera.getSize();
+    auto const maze_w = static_cast<float>(w * cell_size + 2 * scale);
+    auto const maze_h = static_cast<float>(h * cell_size + 2 * scale);
+
+    // Stop zooming in at a few cells and zooming out once the maze is small in the window.
+    if (factor < 1 && std::min(size.x, size.y) * factor < min_visible_cells * cell_size)
+        return;
+    if (factor > 1 && size.x > 2 * maze_w && size.y > 2 * maze_h)
+        return;
+
+    auto const before = window.mapPixelToCoords(pixel, camera);
+    camera.zoom(factor);
+    auto const after = window.mapPixelToCoords(pixel, camera);
+    camera.move(before.x - after.x, before.y - after.y);
+}
+
+void Engine::reset_camera() {
+    auto const window_w = static_cast<float>(std::max(window.getSize().x, 1u));
+    auto const window_h = static_cast<float>(std::max(window.getSize().y, static_cast<unsigned>(top_margin) + 1));
+    auto const view_h = window_h - top_margin;
+
+    // The maze with its margin, one pixel per pixel if it fits and scaled down to fit otherwise.
+    auto const maze_w = static_cast<float>(w * cell_size + 2 * scale);
+    auto const maze_h = static_cast<float>(h * cell_size + 2 * scale);
+    auto const factor = std::max({maze_w / window_w, maze_h / view_h, 1.f});
+
+    camera.setViewport(sf::FloatRect(0, top_margin / window_h, 1, view_h / window_h));
+    camera.setSize(window_w * factor, view_h * factor);
+    camera.setCenter(std::min(maze_w, window_w * factor) / 2, top_margin + std::min(maze_h, view_h * factor) / 2);
+}
+
+int Engine::cell_at(sf::Vector2i pixel) const {
+    // The text above the maze is not part of the camera.
+    if (pixel.y < top_margin)
+        return -1;
+
+    auto const pos = window.mapPixelToCoords(pixel, camera);
+    auto const x = static_cast<int>(std::floor((pos.x - scale) / cell_size));
+    auto const y = static_cast<int>(std::floor((pos.y - scale - top_margin) / cell_size));
+    if (x < 0 || x >= w || y < 0 || y >= h)
+        return -1;
+    return y * w + x;
+}
+
+sf::IntRect Engine::visible_cells() const {
+    auto const center = camera.getCenter();
+    auto const size = camera.getSize();
+    auto const left = (center.x - size.x / 2 - scale) / cell_size;
+    auto const top = (center.y - size.y / 2 - scale - top_margin) / cell_size;
+
+    auto const x0 = std::max(static_cast<int>(std::floor(left)), 0);
+    auto const y0 = std::max(static_cast<int>(std::floor(top)), 0);
+    auto const x1 = std::min(static_cast<int>(std::floor(left + size.x / cell_size)), w - 1);
+    auto const y1 = std::min(static_cast<int>(std::floor(top + size.y / cell_size)), h - 1);
+    return sf::IntRect(x0, y0, std::max(x1 - x0 + 1, 0), std::max(y1 - y0 + 1, 0));
+}
+
 /////////////////////////////////////////////////////////////////////////
 /////// Functions responsible for drawing vertices to the screen. ///////
 /////////////////////////////////////////////////////////////////////////
 
-void Engine::draw_current_node_vertex_array() {
-    if (!go || visited.empty())
+void Engine::advance_animation() {
+    if (!go)
         return;
 
-    auto cur = visited[counter_visited];
-    add_vertices(cur.x, cur.y, color_current);
+    // Stepped searches mark their nodes themselves, only the path is left to animate.
+    if (!stepper) {
+        if (trace.visited_size() == 0)
+            return;
+
+        if (counter_visited + 1 < trace.visited_size()) {
+            auto const idx = trace.visited(counter_visited);
+            marks[static_cast<std::size_t>(idx)] = trace.visited_backward(counter_visited) ? Mark::VisitedBackward : Mark::Visited;
+            mark_dirty(idx);
+            counter_visited++;
+        } else if (!worker.busy()) {
+            finish = true;
+        }
+
+        auto const next = trace.visited(counter_visited);
+        if (next != current) {
+            if (current >= 0)
+                mark_dirty(current);
+            current = next;
+            mark_dirty(current);
+        }
+    }
+
+    if (finish && counter_sp + 1 < trace.path_size()) {
+        auto const idx = trace.path(counter_sp);
+        marks[static_cast<std::size_t>(idx)] = Mark::Path;
+        mark_dirty(idx);
+        counter_sp++;
+    }
+}
+
+sf::Color Engine::color_of(int idx) const {
+    if (idx == current)
+        return color_current;
+
+    auto const cur = maze.get_node(idx);
+    if (!cur.start && !cur.end) {
+        switch (marks[static_cast<std::size_t>(idx)]) {
+            case Mark::Path:
+                return color_shortest_path;
+            case Mark::Open:
+                return color_open;
+            case Mark::Visited:
+                return color_visited;
+            case Mark::VisitedBackward:
+                return color_visited_backward;
+            case Mark::None:
+                break;
+        }
+    }
+
+    if (cur.start && cur.end)
+        return color_start_end;
+    if (cur.start)
+        return color_start;
+    if (cur.end)
+        return color_end;
+    if (!cur.passable)
+        return color_rect_impassable;
+
+    auto const d = show_field ? field.distance(idx) : DistanceField::unreachable;
+    if (d == DistanceField::unreachable)
+        return color_rect;
+
+    auto const t = static_cast<float>(d) / static_cast<float>(std::max(field.max_distance(), 1));
+    auto const mix = [t](sf::Uint8 a, sf::Uint8 b) { return static_cast<sf::Uint8>(a + (b - a) * t); };
+    return sf::Color(mix(color_field_near.r, color_field_far.r), mix(color_field_near.g, color_field_far.g),
+                     mix(color_field_near.b, color_field_far.b));
+}
+
+void Engine::update_cells() {
+    // Any edit can change the distances of the whole heatmap.
+    if (show_field && field_dirty) {
+        field.compute(maze.get_grid(), {maze.get_end().id}, false);
+        field_dirty = false;
+        all_dirty = true;
+    }
+
+    if (all_dirty) {
+        for (auto idx = 0; idx < w * h; ++idx)
+            paint(idx);
+        for (std::size_t k = 0; k < levels.size(); ++k) {
+            auto& level = levels[k];
+            for (auto y = 0; y < level.h; ++y) {
+                for (auto x = 0; x < level.w; ++x)
+                    aggregate(k, x, y);
+            }
+            level.changes.all = true;
+        }
+    } else {
+        for (auto const idx : dirty) {
+            paint(idx);
+
+            // Each level above only changes in the texel that holds the cell.
+            auto x = idx % w;
+            auto y = idx / w;
+            for (std::size_t k = 0; k < levels.size(); ++k) {
+                x /= 2;
+                y /= 2;
+                aggregate(k, x, y);
+                levels[k].changes.add(x, y);
+            }
+        }
+    }
+    upload(all_dirty);
+
+    all_dirty = false;
+    dirty.clear();
+}
+
+std::uint8_t Engine::rank_of(int idx) const {
+    if (idx == current)
+        return 4;
+    auto const cur = maze.get_node(idx);
+    if (cur.start || cur.end)
+        return 3;
+    switch (marks[static_cast<std::size_t>(idx)]) {
+        case Mark::Path:
+            return 2;
+        case Mark::Open:
+        case Mark::Visited:
+        case Mark::VisitedBackward:
+            return 1;
+        case Mark::None:
+            break;
+    }
+    return 0;
+}
+
+void Engine::paint(int idx) {
+    auto const color = color_of(idx);
+    auto const i = static_cast<std::size_t>(idx) * 4;
+    pixels[i] = color.r;
+    pixels[i + 1] = color.g;
+    pixels[i + 2] = color.b;
+    pixels[i + 3] = color.a;
+    ranks[static_cast<std::size_t>(idx)] = rank_of(idx);
+
+    if (mode == RenderMode::Quads) {
+        for (auto v = i; v < i + 4; ++v)
+            vertices[v].color = color;
+    }
+}
+
+void Engine::aggregate(std::size_t level, int x, int y) {
+    auto& dst = levels[level];
+    auto const src_w = level == 0 ? w : levels[level - 1].w;
+    auto const src_h = level == 0 ? h : levels[level - 1].h;
+    auto const& src_pixels = level == 0 ? pixels : levels[level - 1].pixels;
+    auto const& src_ranks = level == 0 ? ranks : levels[level - 1].ranks;
+
+    // The most important of the four texels wins, so a path or the current node stays visible
+    // however far the camera zooms out. Texels of rank 0 are averaged.
+    std::uint8_t best = 0;
+    std::size_t best_texel = 0;
+    unsigned sum[4]{};
+    unsigned count = 0;
+    for (auto sy = 2 * y; sy < std::min(2 * y + 2, src_h); ++sy) {
+        for (auto sx = 2 * x; sx < std::min(2 * x + 2, src_w); ++sx) {
+            auto const texel = static_cast<std::size_t>(sy) * static_cast<std::size_t>(src_w) + static_cast<std::size_t>(sx);
+            if (src_ranks[texel] > best) {
+                best = src_ranks[texel];
+                best_texel = texel;
+            }
+            for (auto c = 0; c < 4; ++c)
+                sum[c] += src_pixels[texel * 4 + c];
+            ++count;
+        }
+    }
+
+    auto const texel = static_cast<std::size_t>(y) * static_cast<std::size_t>(dst.w) + static_cast<std::size_t>(x);
+    dst.ranks[texel] = best;
+    for (auto c = 0; c < 4; ++c) {
+        dst.pixels[texel * 4 + c] =
+            best > 0 ? src_pixels[best_texel * 4 + c] : static_cast<sf::Uint8>(sum[c] / std::max(count, 1u));
+    }
+}
+
+void Engine::build_levels() {
+    // Levels are added until one texel covers the whole maze. They are never resized, as the
+    // textures must not move.
+    auto lw = w;
+    auto lh = h;
+    std::size_t count = 0;
+    for (auto x = w, y = h; x > 1 || y > 1; x = (x + 1) / 2, y = (y + 1) / 2)
+        ++count;
+    levels = std::vector<Level>(count);
+
+    for (auto& level : levels) {
+        lw = (lw + 1) / 2;
+        lh = (lh + 1) / 2;
+        level.w = lw;
+        level.h = lh;
+        level.pixels.assign(static_cast<std::size_t>(lw) * static_cast<std::size_t>(lh) * 4, 0);
+        level.ranks.assign(static_cast<std::size_t>(lw) * static_cast<std::size_t>(lh), 0);
+        level.changes.reset(lw, lh);
+        if (!level.texture.create(static_cast<unsigned>(lw), static_cast<unsigned>(lh)))
+            throw std::runtime_error("Failed to create a texture for the maze");
+    }
+    all_dirty = true;
 }
 
-void Engine::draw_shorest_path_vertex_array() {
-    if (!finish || sp.empty())
+void Engine::draw_cells() {
+    auto const cells = visible_cells();
+    if (cells.width == 0 || cells.height == 0)
         return;
+    window.setView(camera);
+
+    // Once a pixel covers two or more cells, the level with about one texel per pixel is drawn.
+    auto const cells_per_pixel = camera.getSize().x / (static_cast<float>(std::max(window.getSize().x, 1u)) * cell_size);
+    if (cells_per_pixel >= 2 && !levels.empty()) {
+        auto const k = std::min(static_cast<std::size_t>(std::log2(cells_per_pixel)) - 1, levels.size() - 1);
+        auto& level = levels[k];
+        level.changes.upload(level.texture, level.pixels);
+
+        auto const factor = 2 << k;
+        auto const x0 = cells.left / factor;
+        auto const y0 = cells.top / factor;
+        auto const x1 = (cells.left + cells.width - 1) / factor;
+        auto const y1 = (cells.top + cells.height - 1) / factor;
+        level_sprite.setTexture(level.texture);
+        level_sprite.setTextureRect(sf::IntRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1));
+        level_sprite.setScale(static_cast<float>(factor * cell_size), static_cast<float>(factor * cell_size));
+        level_sprite.setPosition(static_cast<float>(x0 * factor * cell_size + scale),
+                                 static_cast<float>(y0 * factor * cell_size + scale + top_margin));
+        window.draw(level_sprite);
+    } else if (mode == RenderMode::Texture) {
+        auto const x_pos = static_cast<float>(cells.left * cell_size + scale);
+        auto const y_pos = static_cast<float>(cells.top * cell_size + scale + top_margin);
+        sprite.setTextureRect(cells);
+        sprite.setPosition(x_pos, y_pos);
+        grid_lines.setTextureRect(
+            sf::IntRect(cells.left * cell_size, cells.top * cell_size, cells.width * cell_size, cells.height * cell_size));
+        grid_lines.setPosition(x_pos, y_pos);
+        window.draw(sprite);
+        window.draw(grid_lines);
+    } else {
+        // Rows are contiguous in the vertices, so full rows are drawn at once and partial rows
+        // one by one.
+        auto const rows = cells.width == w ? 1 : cells.height;
+        auto const count = static_cast<std::size_t>(cells.width) * (cells.width == w ? cells.height : 1) * 4;
+        for (auto y = cells.top; y < cells.top + rows; ++y) {
+            auto const first = (static_cast<std::size_t>(y) * static_cast<std::size_t>(w) + static_cast<std::size_t>(cells.left)) * 4;
+            if (use_buffer)
+                window.draw(buffer, first, count);
+            else
+                window.draw(&vertices[first], count, sf::Quads);
+        }
+    }
 
-    if (counter_sp + 1 < sp.size())
-        counter_sp++;
+    window.setView(window.getDefaultView());
+}
 
-    for (unsigned long i = 0; i < counter_sp; ++i) {
-        auto const cur = sp[i];
-        if (cur.start || cur.end)
-            continue;
+void Engine::upload(bool all) {
+    if (mode == RenderMode::Quads) {
+        if (!use_buffer)
+            return;
+        if (all) {
+            buffer.update(vertices.data());
+            return;
+        }
+        for (auto const idx : dirty)
+            buffer.update(&vertices[static_cast<std::size_t>(idx) * 4], 4, static_cast<unsigned>(idx) * 4);
+        return;
+    }
 
-        add_vertices(cur.x, cur.y, color_shortest_path);
+    if (all) {
+        texture_changes.all = true;
+    } else {
+        for (auto const idx : dirty)
+            texture_changes.add(idx % w, idx / w);
     }
+    texture_changes.upload(texture, pixels);
 }
 
-void Engine::draw_visited_vertex_array() {
-    if (!go || visited.empty())
+void Engine::DirtyTiles::reset(int width, int height) {
+    w = width;
+    columns = (width + dirty_tile_size - 1) / dirty_tile_size;
+    auto const rows = (height + dirty_tile_size - 1) / dirty_tile_size;
+    bounds.assign(static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows), Bounds{});
+    tiles.clear();
+    all = true;
+}
+
+void Engine::DirtyTiles::add(int x, int y) {
+    auto const tile = (y / dirty_tile_size) * columns + x / dirty_tile_size;
+    auto& b = bounds[static_cast<std::size_t>(tile)];
+    if (b.right < b.left) {
+        b = Bounds{x, y, x, y};
+        tiles.push_back(tile);
         return;
-    if (counter_visited + 1 < visited.size())
-        counter_visited++;
-    else
-        finish = true;
+    }
+    b.left = std::min(b.left, x);
+    b.top = std::min(b.top, y);
+    b.right = std::max(b.right, x);
+    b.bottom = std::max(b.bottom, y);
+}
 
-    for (unsigned long i = 0; i < counter_visited; ++i) {
-        auto const cur = visited[i];
-        if (cur.start || cur.end)
+void Engine::DirtyTiles::upload(sf::Texture& texture, const std::vector<sf::Uint8>& pixels) {
+    auto const full = std::exchange(all, false);
+    if (full)
+        texture.update(pixels.data());
+
+    for (auto const tile : tiles) {
+        auto const b = std::exchange(bounds[static_cast<std::size_t>(tile)], Bounds{});
+        if (full)
             continue;
 
-        add_vertices(cur.x, cur.y, color_visited);
+        // A single row or rows as wide as the texture are contiguous in pixels, other rectangles
+        // are packed row by row first.
+        auto const width = static_cast<std::size_t>(b.right - b.left + 1);
+        auto const height = static_cast<std::size_t>(b.bottom - b.top + 1);
+        auto const* src = &pixels[(static_cast<std::size_t>(b.top) * static_cast<std::size_t>(w) + static_cast<std::size_t>(b.left)) * 4];
+        if (height > 1 && width < static_cast<std::size_t>(w)) {
+            staging.resize(width * height * 4);
+            for (std::size_t y = 0; y < height; ++y)
+                std::copy_n(src + y * static_cast<std::size_t>(w) * 4, width * 4, &staging[y * width * 4]);
+            src = staging.data();
+        }
+        texture.update(src, static_cast<unsigned>(width), static_cast<unsigned>(height), static_cast<unsigned>(b.left),
+                       static_cast<unsigned>(b.top));
     }
+    tiles.clear();
 }
 
-void Engine::draw_background_vertex_array() {
-    for (auto &col : maze.maze) {
-        for (auto const &cur : col) {
-            sf::Color color;
-            if (cur.start && cur.end)
-                color = color_start_end;
-            else if (cur.start)
-                color = color_start;
-            else if (cur.end)
-                color = color_end;
-            else if (cur.passable)
-                color = color_rect;
-            else
-                color = color_rect_impassable;
+void Engine::build_vertices() {
+    vertices.resize(static_cast<std::size_t>(w) * static_cast<std::size_t>(h) * 4);
 
-            add_vertices(cur.x, cur.y, color);
-        }
+    for (auto idx = 0; idx < w * h; ++idx) {
+        auto const x_pos = static_cast<float>((idx % w) * cell_size + scale);
+        auto const y_pos = static_cast<float>((idx / w) * cell_size + scale + top_margin);
+
+        auto* quad = &vertices[static_cast<std::size_t>(idx) * 4];
+        quad[0].position = sf::Vector2f(x_pos, y_pos);
+        quad[1].position = sf::Vector2f(x_pos, y_pos + scale);
+        quad[2].position = sf::Vector2f(x_pos + scale, y_pos + scale);
+        quad[3].position = sf::Vector2f(x_pos + scale, y_pos);
     }
+
+    use_buffer = sf::VertexBuffer::isAvailable() && buffer.create(vertices.size());
+    all_dirty = true;
 }
 
-void Engine::add_vertices(int x, int y, sf::Color color) {
-    auto x_pos = (x * (scale + border_size * 2)) + scale;
-    auto y_pos = (y * (scale + border_size * 2)) + scale + top_margin;
+void Engine::build_texture() {
+    if (!texture.create(static_cast<unsigned>(w), static_cast<unsigned>(h)))
+        throw std::runtime_error("Failed to create a texture for the maze");
+    texture_changes.reset(w, h);
+
+    // Every texel covers a cell and the gap after it, like a quad and its border.
+    sprite.setTexture(texture, true);
+    sprite.setPosition(scale, scale + top_margin);
+    sprite.setScale(cell_size, cell_size);
+
+    // The gaps between the cells are painted over by a transparent tile with the gap in the
+    // background color, repeated across the maze.
+    std::vector<sf::Uint8> tile(static_cast<std::size_t>(cell_size) * cell_size * 4, 0);
+    for (auto y = 0; y < cell_size; ++y) {
+        for (auto x = 0; x < cell_size; ++x) {
+            if (x < scale && y < scale)
+                continue;
+            auto* texel = &tile[static_cast<std::size_t>(y * cell_size + x) * 4];
+            texel[0] = color_bg.r;
+            texel[1] = color_bg.g;
+            texel[2] = color_bg.b;
+            texel[3] = color_bg.a;
+        }
+    }
+    if (!grid_tile.create(cell_size, cell_size))
+        throw std::runtime_error("Failed to create a texture for the grid lines");
+    grid_tile.update(tile.data());
+    grid_tile.setRepeated(true);
 
-    vertices.push_back(sf::Vertex(sf::Vector2f(x_pos, y_pos), color));
-    vertices.push_back(sf::Vertex(sf::Vector2f(x_pos, y_pos + scale), color));
-    vertices.push_back(sf::Vertex(sf::Vector2f(x_pos + scale, y_pos + scale), color));
-    vertices.push_back(sf::Vertex(sf::Vector2f(x_pos + scale, y_pos), color));
+    grid_lines.setTexture(grid_tile);
+    all_dirty = true;
 }
 
 void Engine::draw_text() {
@@ -230,7 +812,7 @@ void Engine::draw_text() {
     text.setFont(font);
     text.setPosition(sf::Vector2f(scale, scale));
 
-    auto s = finish && !sp.empty() ? fmt::format("Steps: {}  Shortest path: {}", counter_visited, counter_sp) : fmt::format("Steps: {}", counter_visited);
+    auto s = finish && trace.path_size() != 0 ? fmt::format("Steps: {}  Shortest path: {}", counter_visited, counter_sp) : fmt::format("Steps: {}", counter_visited);
 
     text.setString(s);
 
@@ -247,6 +829,19 @@ void Engine::draw_text() {
 
     text.setPosition(sf::Vector2f(x, scale));
     window.draw(text);
+
+    // Statistics of the search in a smaller second line.
+    auto const& stats = trace.stats();
+    text.setString(fmt::format("Expanded: {}  Generated: {}  Peak frontier: {}  Path cost: {}  Time: {:.3f}ms",
+                               stats.expanded,
+                               stats.generated,
+                               stats.peak_frontier,
+                               stats.path_cost,
+                               stats.wall_time_ns / 1e6));
+    text.setCharacterSize(18);
+    text.setStyle(sf::Text::Regular);
+    text.setPosition(sf::Vector2f(scale, scale + 34));
+    window.draw(text);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -273,43 +868,42 @@ void Engine::draw_rectangle(int x, int y, const sf::Color color) {
 
 void Engine::draw_background() {
     // TODO: optimize this to vertex array.
-    for (auto &col : maze.maze) {
-        for (auto const &n : col) {
-            auto draw = true;
-            sf::Color color;
-            if (n.start && n.end)
-                color = color_start_end;
-            else if (n.start)
-                color = color_start;
-            else if (n.end)
-                color = color_end;
-            else if (n.passable)
-                color = color_rect;
-            else
-                color = color_rect_impassable;
+    for (auto idx = 0; idx < w * h; ++idx) {
+        auto const n = maze.get_node(idx);
+        auto draw = true;
+        sf::Color color;
+        if (n.start && n.end)
+            color = color_start_end;
+        else if (n.start)
+            color = color_start;
+        else if (n.end)
+            color = color_end;
+        else if (n.passable)
+            color = color_rect;
+        else
+            color = color_rect_impassable;
 
-            // Skip the drawing for nodes that will be drawn as visited.
-            for (unsigned long i = 0; i < counter_visited; ++i) {
-                if (!visited.empty() && n.id == visited[i].id && n.id != maze.start.id)
-                    draw = false;
-                break;
-            }
-            if (draw)
-                draw_rectangle(n.x, n.y, color);
+        // Skip the drawing for nodes that will be drawn as visited.
+        for (unsigned long i = 0; i < counter_visited; ++i) {
+            if (trace.visited_size() != 0 && n.id == trace.visited(i) && n.id != maze.get_start().id)
+                draw = false;
+            break;
         }
+        if (draw)
+            draw_rectangle(n.x, n.y, color);
     }
 }
 
 void Engine::draw_visited() {
-    if (!go || visited.empty())
+    if (!go || trace.visited_size() == 0)
         return;
-    if (counter_visited + 1 < visited.size())
+    if (counter_visited + 1 < trace.visited_size())
         counter_visited++;
     else
         finish = true;
 
     for (unsigned long i = 0; i < counter_visited; ++i) {
-        auto const cur = visited[i];
+        auto const cur = maze.get_node(trace.visited(i));
         if (cur.start || cur.end)
             continue;
         draw_rectangle(cur.x, cur.y, color_visited);
@@ -317,21 +911,21 @@ void Engine::draw_visited() {
 }
 
 void Engine::draw_current_node() {
-    if (!go || visited.empty())
+    if (!go || trace.visited_size() == 0)
         return;
-    auto cur = visited[counter_visited];
+    auto cur = maze.get_node(trace.visited(counter_visited));
     draw_rectangle(cur.x, cur.y, color_current);
 }
 
 void Engine::draw_shortest_path() {
-    if (!finish || sp.empty())
+    if (!finish || trace.path_size() == 0)
         return;
 
-    if (counter_sp + 1 < sp.size())
+    if (counter_sp + 1 < trace.path_size())
         counter_sp++;
 
     for (unsigned long i = 0; i < counter_sp; ++i) {
-        auto const cur = sp[i];
+        auto const cur = maze.get_node(trace.path(i));
         if (cur.start || cur.end)
             continue;
         draw_rectangle(cur.x, cur.y, color_shortest_path);
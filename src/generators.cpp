@@ -0,0 +1,339 @@
+#include "generators.h"
+
+#include <algorithm>
+#include <array>
+
+#include "grid_metrics.h"
+
+namespace generators {
+
+namespace {
+
+/**
+ * The rooms of a grid, numbered row by row.
+ */
+struct Rooms {
+    int w;  /// Number of rooms per row.
+    int h;  /// Number of rooms per column.
+
+    explicit Rooms(const Grid& grid) : w{(grid.width() + 1) / 2}, h{(grid.height() + 1) / 2} {}
+
+    int size() const { return w * h; }
+
+    /**
+     * Calls f(neighbor) for every room next to room r.
+     */
+    template <typename F>
+    void for_each_neighbor(int r, F&& f) const {
+        auto const i = r % w;
+        auto const j = r / w;
+        if (i > 0)
+            f(r - 1);
+        if (i + 1 < w)
+            f(r + 1);
+        if (j > 0)
+            f(r - w);
+        if (j + 1 < h)
+            f(r + w);
+    }
+
+    /**
+     * Opens room r.
+     */
+    void open(Grid& grid, int r) const { grid.set_passable(2 * (r % w), 2 * (r / w), true); }
+
+    /**
+     * Opens the rooms a and b and the cell between them.
+     */
+    void connect(Grid& grid, int a, int b) const {
+        open(grid, a);
+        open(grid, b);
+        grid.set_passable(a % w + b % w, a / w + b / w, true);
+    }
+};
+
+/**
+ * A wall between two neighboring rooms.
+ */
+struct Wall {
+    int a;
+    int b;
+};
+
+/**
+ * Returns a random number in [0, n), without the cost of a distribution.
+ */
+int below(std::mt19937& rng, int n) {
+    return static_cast<int>((static_cast<std::uint64_t>(rng()) * static_cast<std::uint64_t>(n)) >> 32);
+}
+
+}  // namespace
+
+void recursive_backtracker(Grid& grid, std::uint32_t seed) {
+    auto const rooms = Rooms{grid};
+    grid.fill(false);
+    if (rooms.size() == 0)
+        return;
+
+    std::mt19937 rng(seed);
+    std::vector<bool> visited(rooms.size());
+    std::vector<int> stack;
+
+    auto const first = below(rng, rooms.size());
+    visited[first] = true;
+    rooms.open(grid, first);
+    stack.push_back(first);
+
+    while (!stack.empty()) {
+        auto const cur = stack.back();
+
+        std::array<int, 4> options{};
+        auto count = 0;
+        rooms.for_each_neighbor(cur, [&](int n) {
+            if (!visited[n])
+                options[count++] = n;
+        });
+
+        // Backtrack from a dead end.
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        auto const next = options[below(rng, count)];
+        visited[next] = true;
+        rooms.connect(grid, cur, next);
+        stack.push_back(next);
+    }
+}
+
+void kruskal(Grid& grid, std::uint32_t seed) {
+    auto const rooms = Rooms{grid};
+    grid.fill(false);
+
+    std::mt19937 rng(seed);
+    std::vector<Wall> walls;
+    walls.reserve(2 * static_cast<std::size_t>(rooms.size()));
+    for (auto r = 0; r < rooms.size(); ++r) {
+        rooms.open(grid, r);
+        if (r % rooms.w + 1 < rooms.w)
+            walls.push_back({r, r + 1});
+        if (r / rooms.w + 1 < rooms.h)
+            walls.push_back({r, r + rooms.w});
+    }
+    std::shuffle(walls.begin(), walls.end(), rng);
+
+    // Every room starts as its own tree.
+    std::vector<int> parent(rooms.size());
+    for (auto r = 0; r < rooms.size(); ++r)
+        parent[r] = r;
+
+    for (auto const [a, b] : walls) {
+        auto const root_a = find_root(parent, a);
+        auto const root_b = find_root(parent, b);
+        if (root_a == root_b)
+            continue;
+        parent[root_b] = root_a;
+        rooms.connect(grid, a, b);
+    }
+}
+
+void prim(Grid& grid, std::uint32_t seed) {
+    auto const rooms = Rooms{grid};
+    grid.fill(false);
+    if (rooms.size() == 0)
+        return;
+
+    std::mt19937 rng(seed);
+    std::vector<bool> visited(rooms.size());
+    std::vector<Wall> border;  // Walls from a room of the tree to a room that may not be.
+
+    auto const add = [&](int r) {
+        visited[r] = true;
+        rooms.for_each_neighbor(r, [&](int n) {
+            if (!visited[n])
+                border.push_back({r, n});
+        });
+    };
+
+    auto const first = below(rng, rooms.size());
+    rooms.open(grid, first);
+    add(first);
+
+    while (!border.empty()) {
+        auto const k = below(rng, static_cast<int>(border.size()));
+        auto const [a, b] = border[k];
+        border[k] = border.back();
+        border.pop_back();
+
+        if (visited[b])
+            continue;
+        rooms.connect(grid, a, b);
+        add(b);
+    }
+}
+
+void wilson(Grid& grid, std::uint32_t seed) {
+    auto const rooms = Rooms{grid};
+    grid.fill(false);
+    if (rooms.size() == 0)
+        return;
+
+    std::mt19937 rng(seed);
+    std::vector<bool> in_tree(rooms.size());
+    std::vector<int> next(rooms.size());  // Last step of the walk out of every room.
+
+    auto const root = below(rng, rooms.size());
+    in_tree[root] = true;
+    rooms.open(grid, root);
+
+    for (auto r = 0; r < rooms.size(); ++r) {
+        // Walk randomly until the tree is hit. Overwriting the step out of a room that is entered
+        // again erases the loop.
+        for (auto cur = r; !in_tree[cur]; cur = next[cur]) {
+            std::array<int, 4> options{};
+            auto count = 0;
+            rooms.for_each_neighbor(cur, [&](int n) { options[count++] = n; });
+            next[cur] = options[below(rng, count)];
+        }
+
+        // Add the loop-erased walk to the tree.
+        for (auto cur = r; !in_tree[cur]; cur = next[cur]) {
+            in_tree[cur] = true;
+            rooms.connect(grid, cur, next[cur]);
+        }
+    }
+}
+
+void eller(Grid& grid, std::uint32_t seed) {
+    EllerStream stream(grid.width(), grid.height(), seed);
+    for (auto y = 0; y < grid.height(); ++y)
+        grid.set_row(y, stream.next());
+}
+
+void generate(Algorithm algorithm, Grid& grid, std::uint32_t seed) {
+    switch (algorithm) {
+        case Algorithm::RecursiveBacktracker:
+            recursive_backtracker(grid, seed);
+            break;
+        case Algorithm::Kruskal:
+            kruskal(grid, seed);
+            break;
+        case Algorithm::Prim:
+            prim(grid, seed);
+            break;
+        case Algorithm::Wilson:
+            wilson(grid, seed);
+            break;
+        case Algorithm::Eller:
+            eller(grid, seed);
+            break;
+    }
+}
+
+EllerStream::EllerStream(int width, int height, std::uint32_t seed)
+    : w{width}, h{height}, rooms{(width + 1) / 2}, rng{seed} {
+    // Two labels per room, so there are always enough free labels for the rooms of a new row.
+    set.resize(rooms);
+    parent.resize(2 * static_cast<std::size_t>(rooms));
+    remaining.resize(parent.size());
+    down.resize(parent.size());
+    free.reserve(parent.size());
+
+    row.resize((width + 63) / 64);
+    passage.resize(row.size());
+
+    for (auto i = 0; i < rooms; ++i)
+        set[i] = i;
+}
+
+bool EllerStream::coin() {
+    if (bits_left == 0) {
+        bits = rng();
+        bits_left = 64;
+    }
+    auto const res = (bits & 1u) != 0;
+    bits >>= 1;
+    --bits_left;
+    return res;
+}
+
+int EllerStream::find(int label) {
+    return find_root(parent, label);
+}
+
+void EllerStream::next_rooms() {
+    auto const last = y + 2 >= h;  // The last row joins every set.
+    auto const set_bit = [](std::vector<std::uint64_t>& words, int x) {
+        words[x >> 6] |= std::uint64_t{1} << (x & 63);
+    };
+
+    std::fill(row.begin(), row.end(), 0);
+    std::fill(passage.begin(), passage.end(), 0);
+    for (std::size_t l = 0; l < parent.size(); ++l)
+        parent[l] = static_cast<int>(l);
+
+    // Join neighbors of different sets, cur is the set of room i.
+    auto cur = rooms > 0 ? set[0] : 0;
+    for (auto i = 0; i < rooms; ++i) {
+        set_bit(row, 2 * i);
+        if (i + 1 == rooms)
+            break;
+
+        auto const next = find(set[i + 1]);
+        if (next != cur && (last || coin())) {
+            parent[next] = cur;
+            set_bit(row, 2 * i + 1);
+        } else {
+            cur = next;
+        }
+    }
+
+    if (last)
+        return;
+
+    // Continue every set downwards through random rooms, but at least through its last one.
+    std::fill(remaining.begin(), remaining.end(), 0);
+    std::fill(down.begin(), down.end(), 0);
+    for (auto i = 0; i < rooms; ++i) {
+        set[i] = find(set[i]);
+        ++remaining[set[i]];
+    }
+
+    for (auto i = 0; i < rooms; ++i) {
+        auto const s = set[i];
+        --remaining[s];
+        if (coin() || (remaining[s] == 0 && !down[s])) {
+            down[s] = 1;
+            set_bit(passage, 2 * i);
+        } else {
+            set[i] = -1;
+        }
+    }
+
+    // Rooms that are not connected from above start a new set.
+    free.clear();
+    for (std::size_t l = 0; l < down.size(); ++l) {
+        if (!down[l])
+            free.push_back(static_cast<int>(l));
+    }
+    for (auto i = 0; i < rooms; ++i) {
+        if (set[i] < 0) {
+            set[i] = free.back();
+            free.pop_back();
+        }
+    }
+}
+
+const std::uint64_t* EllerStream::next() {
+    // Even rows hold the rooms, odd rows the passages below them.
+    if (y % 2 == 0) {
+        next_rooms();
+        ++y;
+        return row.data();
+    }
+    ++y;
+    return passage.data();
+}
+
+}  // namespace generators
@@ -0,0 +1,81 @@
+#include "grid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+Grid::Grid(int width, int height, bool passable)
+    : w{width}, h{height}, stride{(width + 63) / 64} {
+    assert(width >= 0);
+    assert(height >= 0);
+
+    words.assign(static_cast<std::size_t>(stride) * h, 0);
+    plane = words.data();
+    fill(passable);
+}
+
+Grid Grid::view(int width, int height, std::uint64_t* plane, std::shared_ptr<void> owner) {
+    Grid grid;
+    grid.w = width;
+    grid.h = height;
+    grid.stride = (width + 63) / 64;
+    grid.owner = std::move(owner);
+    grid.plane = plane;
+    return grid;
+}
+
+Grid::Grid(const Grid& other)
+    : w{other.w},
+      h{other.h},
+      stride{other.stride},
+      words(other.plane, other.plane + static_cast<std::size_t>(other.stride) * other.h) {
+    plane = words.data();
+}
+
+Grid& Grid::operator=(const Grid& other) {
+    if (this != &other)
+        *this = Grid(other);
+    return *this;
+}
+
+void Grid::set_passable(int x, int y, bool passable) {
+    auto& word = plane[static_cast<std::size_t>(y) * stride + (x >> 6)];
+    auto const bit = std::uint64_t{1} << (x & 63);
+
+    if (passable)
+        word |= bit;
+    else
+        word &= ~bit;
+}
+
+void Grid::set_row(int y, const std::uint64_t* bits) {
+    if (stride == 0)
+        return;
+
+    auto* r = plane + static_cast<std::size_t>(y) * stride;
+    std::copy(bits, bits + stride, r);
+
+    // Keep the padding bits past the width at zero.
+    auto const tail = w & 63;
+    if (tail != 0)
+        r[stride - 1] &= (std::uint64_t{1} << tail) - 1;
+}
+
+void Grid::fill(bool passable) {
+    auto const size = static_cast<std::size_t>(stride) * h;
+    if (!passable || stride == 0) {
+        std::fill(plane, plane + size, 0);
+        return;
+    }
+
+    // Keep the padding bits past the width at zero.
+    auto const tail = w & 63;
+    auto const last = tail == 0 ? ~std::uint64_t{0} : (std::uint64_t{1} << tail) - 1;
+
+    for (auto y = 0; y < h; ++y) {
+        auto* r = plane + static_cast<std::size_t>(y) * stride;
+        for (auto i = 0; i < stride - 1; ++i)
+            r[i] = ~std::uint64_t{0};
+        r[stride - 1] = last;
+    }
+}
@@ -0,0 +1,410 @@
+#include "hpa.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "grid_metrics.h"
+
+namespace hpa {
+
+namespace {
+
+/// Runs of at least this many crossable cells get a transition at both ends, shorter runs one in the middle.
+constexpr int long_entrance = 6;
+
+/// Clusters per chunk when clusters are built in parallel.
+constexpr std::size_t cluster_grain = 16;
+
+/**
+ * Cells of a cluster, [x0, x1) x [y0, y1).
+ */
+struct Rect {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+
+    int size() const { return (x1 - x0) * (y1 - y0); }
+    bool contains(int x, int y) const { return x >= x0 && x < x1 && y >= y0 && y < y1; }
+    int local(int x, int y) const { return (y - y0) * (x1 - x0) + (x - x0); }
+};
+
+Rect cluster_rect(int cx, int cy, int w, int h) {
+    auto const x0 = cx * cluster_size;
+    auto const y0 = cy * cluster_size;
+    return Rect{x0, y0, std::min(w, x0 + cluster_size), std::min(h, y0 + cluster_size)};
+}
+
+/**
+ * Appends the pair <a, b> to out if a diagonal step from a to b squeezes between two impassable
+ * cells. Other diagonal steps can be replaced by two straight steps over the same borders.
+ */
+void diagonal_transition(const Grid& grid, int ax, int ay, int bx, int by, std::vector<std::pair<int, int>>& out) {
+    if (grid.open(ax, ay) && grid.open(bx, by) && !grid.passable(bx, ay) && !grid.passable(ax, by))
+        out.emplace_back(grid.index(ax, ay), grid.index(bx, by));
+}
+
+/**
+ * Appends the transitions of the border between two neighboring clusters to out, as pairs
+ * <cell in the first cluster, cell in the second cluster>. The first cluster lies left of or
+ * above the second one. The result only depends on the cells next to the border, so both
+ * clusters compute the same transitions.
+ *
+ * @param vertical True if the clusters are left and right of each other.
+ * @param line Last column (row) of the first cluster.
+ * @param from First row (column) of the border.
+ * @param to One past the last row (column) of the border.
+ */
+void border_transitions(const Grid& grid, bool vertical, int line, int from, int to,
+                        std::vector<std::pair<int, int>>& out) {
+    auto const cell = [&grid, vertical, line](int i, int side) {
+        return vertical ? grid.index(line + side, i) : grid.index(i, line + side);
+    };
+    auto const crossable = [&grid, vertical, line](int i) {
+        return vertical ? grid.passable(line, i) && grid.passable(line + 1, i)
+                        : grid.passable(i, line) && grid.passable(i, line + 1);
+    };
+
+    auto run = -1;  // First cell of the current run of crossable cells.
+    for (auto i = from; i <= to; ++i) {
+        if (i < to && crossable(i)) {
+            if (run < 0)
+                run = i;
+            continue;
+        }
+        if (run < 0)
+            continue;
+
+        auto const length = i - run;
+        if (length < long_entrance) {
+            out.emplace_back(cell(run + length / 2, 0), cell(run + length / 2, 1));
+        } else {
+            out.emplace_back(cell(run, 0), cell(run, 1));
+            out.emplace_back(cell(i - 1, 0), cell(i - 1, 1));
+        }
+        run = -1;
+    }
+
+    if constexpr (diagonal_movement) {
+        for (auto i = from; i < to; ++i) {
+            for (auto const j : {i - 1, i + 1}) {
+                if (j < from || j >= to)
+                    continue;
+                if (vertical)
+                    diagonal_transition(grid, line, i, line + 1, j, out);
+                else
+                    diagonal_transition(grid, i, line, j, line + 1, out);
+            }
+        }
+    }
+}
+
+/**
+ * Breadth first search from source that does not leave rect.
+ *
+ * @param dist Receives the distance of every cell of rect, -1 if it is not reachable.
+ * @param parent Receives the predecessor of every reached cell of rect, if not null.
+ * @param queue Scratch buffer.
+ */
+void local_bfs(const Grid& grid, const Rect& rect, int source, std::vector<int>& dist, std::vector<int>* parent,
+               std::vector<int>& queue) {
+    dist.assign(rect.size(), -1);
+    if (parent)
+        parent->assign(rect.size(), -1);
+
+    queue.clear();
+    queue.push_back(source);
+    dist[rect.local(grid.x_of(source), grid.y_of(source))] = 0;
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        auto const cur = queue[head];
+        auto const d = dist[rect.local(grid.x_of(cur), grid.y_of(cur))] + 1;
+
+        grid.for_each_neighbor(cur, [&](int n) {
+            auto const x = grid.x_of(n);
+            auto const y = grid.y_of(n);
+            if (!rect.contains(x, y) || dist[rect.local(x, y)] >= 0)
+                return;
+
+            dist[rect.local(x, y)] = d;
+            if (parent)
+                (*parent)[rect.local(x, y)] = cur;
+            queue.push_back(n);
+        });
+    }
+}
+
+}  // namespace
+
+void Graph::build_cluster(const Grid& grid, int k) {
+    auto const cx = k % columns;
+    auto const cy = k / columns;
+    auto const rect = cluster_rect(cx, cy, w, h);
+    auto& cluster = clusters[k];
+
+    // Pairs <cell in this cluster, cell in the other cluster>.
+    std::vector<std::pair<int, int>> own;
+    std::vector<std::pair<int, int>> pairs;
+    auto const collect = [&own, &pairs](bool first) {
+        for (auto const& [a, b] : pairs)
+            own.emplace_back(first ? a : b, first ? b : a);
+        pairs.clear();
+    };
+
+    if (cx > 0) {
+        border_transitions(grid, true, rect.x0 - 1, rect.y0, rect.y1, pairs);
+        collect(false);
+    }
+    if (cx + 1 < columns) {
+        border_transitions(grid, true, rect.x1 - 1, rect.y0, rect.y1, pairs);
+        collect(true);
+    }
+    if (cy > 0) {
+        border_transitions(grid, false, rect.y0 - 1, rect.x0, rect.x1, pairs);
+        collect(false);
+    }
+    if (cy + 1 < rows) {
+        border_transitions(grid, false, rect.y1 - 1, rect.x0, rect.x1, pairs);
+        collect(true);
+    }
+
+    // Diagonal steps over the corners, where four clusters meet.
+    if constexpr (diagonal_movement) {
+        diagonal_transition(grid, rect.x1 - 1, rect.y1 - 1, rect.x1, rect.y1, pairs);
+        collect(true);
+        diagonal_transition(grid, rect.x0 - 1, rect.y0 - 1, rect.x0, rect.y0, pairs);
+        collect(false);
+        diagonal_transition(grid, rect.x0, rect.y1 - 1, rect.x0 - 1, rect.y1, pairs);
+        collect(true);
+        diagonal_transition(grid, rect.x1, rect.y0 - 1, rect.x1 - 1, rect.y0, pairs);
+        collect(false);
+    }
+
+    cluster.nodes.clear();
+    cluster.links.clear();
+    for (auto const& [cell, other] : own) {
+        auto const it = std::find(cluster.nodes.begin(), cluster.nodes.end(), cell);
+        auto const i = static_cast<int>(it - cluster.nodes.begin());
+        if (it == cluster.nodes.end())
+            cluster.nodes.push_back(cell);
+        cluster.links.emplace_back(i, other);
+    }
+
+    // Distances between the nodes inside the cluster.
+    auto const n = cluster.nodes.size();
+    cluster.distances.assign(n * n, -1);
+
+    std::vector<int> dist;
+    std::vector<int> queue;
+    for (std::size_t i = 0; i < n; ++i) {
+        local_bfs(grid, rect, cluster.nodes[i], dist, nullptr, queue);
+        for (std::size_t j = 0; j < n; ++j) {
+            auto const cell = cluster.nodes[j];
+            cluster.distances[i * n + j] = dist[rect.local(grid.x_of(cell), grid.y_of(cell))];
+        }
+    }
+
+    cluster.dirty = false;
+}
+
+void Graph::mark(int cx, int cy) {
+    if (cx < 0 || cx >= columns || cy < 0 || cy >= rows)
+        return;
+
+    auto const k = cy * columns + cx;
+    if (clusters[k].dirty)
+        return;
+    clusters[k].dirty = true;
+    dirty.push_back(k);
+}
+
+void Graph::build(const Grid& grid, ThreadPool& pool) {
+    w = grid.width();
+    h = grid.height();
+    columns = (w + cluster_size - 1) / cluster_size;
+    rows = (h + cluster_size - 1) / cluster_size;
+
+    clusters.assign(static_cast<std::size_t>(columns) * rows, Cluster{});
+    dirty.resize(clusters.size());
+    for (std::size_t k = 0; k < dirty.size(); ++k)
+        dirty[k] = static_cast<int>(k);
+
+    update(grid, pool);
+}
+
+void Graph::update(const Grid& grid, ThreadPool& pool) {
+    pool.parallel_for(dirty.size(), cluster_grain, [this, &grid](std::size_t begin, std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i)
+            build_cluster(grid, dirty[i]);
+    });
+    dirty.clear();
+}
+
+void Graph::invalidate(int x, int y) {
+    if (clusters.empty())
+        return;
+
+    auto const cx = x / cluster_size;
+    auto const cy = y / cluster_size;
+    auto const rect = cluster_rect(cx, cy, w, h);
+
+    auto const left = x == rect.x0;
+    auto const right = x == rect.x1 - 1;
+    auto const top = y == rect.y0;
+    auto const bottom = y == rect.y1 - 1;
+
+    mark(cx, cy);
+    if (left)
+        mark(cx - 1, cy);
+    if (right)
+        mark(cx + 1, cy);
+    if (top)
+        mark(cx, cy - 1);
+    if (bottom)
+        mark(cx, cy + 1);
+
+    if constexpr (diagonal_movement) {
+        if (left && top)
+            mark(cx - 1, cy - 1);
+        if (right && top)
+            mark(cx + 1, cy - 1);
+        if (left && bottom)
+            mark(cx - 1, cy + 1);
+        if (right && bottom)
+            mark(cx + 1, cy + 1);
+    }
+}
+
+std::size_t Graph::size() const {
+    std::size_t res = 0;
+    for (auto const& cluster : clusters)
+        res += cluster.nodes.size();
+    return res;
+}
+
+int Graph::find_path(const Grid& grid, SearchWorkspace& workspace, int start, int end, SearchTrace& trace) const {
+    auto& stats = trace.stats();
+
+    auto const cluster_of = [&grid](int idx) {
+        return std::make_pair(grid.x_of(idx) / cluster_size, grid.y_of(idx) / cluster_size);
+    };
+    auto const index_of = [this](std::pair<int, int> c) { return c.second * columns + c.first; };
+    auto const local_of = [&grid](const Rect& rect, int idx) { return rect.local(grid.x_of(idx), grid.y_of(idx)); };
+
+    // Distances from the start and to the end inside their clusters connect them to the graph.
+    auto const start_cluster = cluster_of(start);
+    auto const end_cluster = cluster_of(end);
+    auto const start_rect = cluster_rect(start_cluster.first, start_cluster.second, w, h);
+    auto const end_rect = cluster_rect(end_cluster.first, end_cluster.second, w, h);
+
+    std::vector<int> start_dist;
+    std::vector<int> end_dist;
+    std::vector<int> queue;
+    local_bfs(grid, start_rect, start, start_dist, nullptr, queue);
+    local_bfs(grid, end_rect, end, end_dist, nullptr, queue);
+
+    auto const end_x = grid.x_of(end);
+    auto const end_y = grid.y_of(end);
+    auto const heuristic = [&grid, end_x, end_y](int idx) {
+        return grid_distance(grid.x_of(idx) - end_x, grid.y_of(idx) - end_y);
+    };
+
+    auto& pq = workspace.heap;
+    workspace.visit(start, 0, start);
+    pq.push(heuristic(start), start);
+
+    while (!pq.empty()) {
+        stats.peak_frontier = std::max(stats.peak_frontier, pq.size());
+
+        auto const cur = pq.pop().second;
+        ++stats.pops;
+        trace.add_visited(cur);
+        if (cur == end)
+            break;
+
+        ++stats.expanded;
+        auto const g = workspace.distance(cur);
+        auto const relax = [&](int n, int cost) {
+            auto const alt = g + cost;
+            if (alt < workspace.distance(n)) {
+                stats.generated += !workspace.visited(n);
+                workspace.visit(n, alt, cur);
+                pq.push(alt + heuristic(n), n, -alt);
+                ++stats.pushes;
+            }
+        };
+
+        auto const c = cluster_of(cur);
+        auto const& cluster = clusters[index_of(c)];
+
+        if (cur == start) {
+            for (auto const node : cluster.nodes) {
+                auto const d = start_dist[local_of(start_rect, node)];
+                if (d > 0)
+                    relax(node, d);
+            }
+        }
+
+        auto const it = std::find(cluster.nodes.begin(), cluster.nodes.end(), cur);
+        if (it != cluster.nodes.end()) {
+            auto const i = static_cast<std::size_t>(it - cluster.nodes.begin());
+            auto const n = cluster.nodes.size();
+            for (std::size_t j = 0; j < n; ++j) {
+                auto const d = cluster.distances[i * n + j];
+                if (d > 0)
+                    relax(cluster.nodes[j], d);
+            }
+            for (auto const& [node, other] : cluster.links) {
+                if (static_cast<std::size_t>(node) == i)
+                    relax(other, 1);
+            }
+        }
+
+        if (c == end_cluster) {
+            auto const d = end_dist[local_of(end_rect, cur)];
+            if (d >= 0)
+                relax(end, d);
+        }
+    }
+
+    if (!workspace.visited(end))
+        return -1;
+
+    // The abstract path from the start to the end.
+    std::vector<int> abstract;
+    for (auto cur = end; ; cur = workspace.parent_of(cur)) {
+        abstract.push_back(cur);
+        if (cur == workspace.parent_of(cur))
+            break;
+    }
+    std::reverse(abstract.begin(), abstract.end());
+
+    // Refine every abstract edge inside a cluster with a search in the cluster. Edges between
+    // clusters are transitions of neighboring cells.
+    std::vector<int> dist;
+    std::vector<int> parent;
+    std::vector<int> segment;
+    trace.add_path(start);
+    for (std::size_t i = 1; i < abstract.size(); ++i) {
+        auto const from = abstract[i - 1];
+        auto const to = abstract[i];
+        auto const c = cluster_of(from);
+        if (c != cluster_of(to)) {
+            trace.add_path(to);
+            continue;
+        }
+
+        auto const rect = cluster_rect(c.first, c.second, w, h);
+        local_bfs(grid, rect, from, dist, &parent, queue);
+
+        segment.clear();
+        for (auto cur = to; cur != from; cur = parent[local_of(rect, cur)])
+            segment.push_back(cur);
+        for (auto it = segment.rbegin(); it != segment.rend(); ++it)
+            trace.add_path(*it);
+    }
+
+    return workspace.distance(end);
+}
+
+}  // namespace hpa
@@ -0,0 +1,126 @@
+#include "indexed_heap.h"
+
+#include <cassert>
+
+void IndexedHeap::prepare(int cells) {
+    if (position.size() != static_cast<std::size_t>(cells)) {
+        heap.clear();
+        position.assign(cells, -1);
+        return;
+    }
+    clear();
+}
+
+void IndexedHeap::clear() {
+    for (auto const& e : heap)
+        position[e.idx] = -1;
+    heap.clear();
+}
+
+void IndexedHeap::push(int priority, int idx, int tie) {
+    auto const pos = position[idx];
+    auto const entry = Entry{priority, tie, idx};
+
+    if (pos < 0) {
+        heap.push_back(entry);
+        sift_up(heap.size() - 1);
+        return;
+    }
+
+    // Only ever lower the priority of a queued cell.
+    if (entry < heap[pos]) {
+        heap[pos] = entry;
+        sift_up(static_cast<std::size_t>(pos));
+    }
+}
+
+void IndexedHeap::update(int priority, int idx, int tie) {
+    auto const pos = position[idx];
+    if (pos < 0) {
+        push(priority, idx, tie);
+        return;
+    }
+
+    auto const entry = Entry{priority, tie, idx};
+    auto const raised = heap[pos] < entry;
+    heap[pos] = entry;
+    if (raised)
+        sift_down(static_cast<std::size_t>(pos));
+    else
+        sift_up(static_cast<std::size_t>(pos));
+}
+
+void IndexedHeap::remove(int idx) {
+    auto const pos = position[idx];
+    if (pos < 0)
+        return;
+    position[idx] = -1;
+
+    // Move the last entry into the gap, it may belong above or below it.
+    auto const last = heap.back();
+    heap.pop_back();
+    if (static_cast<std::size_t>(pos) == heap.size())
+        return;
+
+    heap[pos] = last;
+    sift_up(static_cast<std::size_t>(pos));
+    sift_down(static_cast<std::size_t>(position[last.idx]));
+}
+
+std::pair<int, int> IndexedHeap::pop() {
+    assert(!heap.empty());
+
+    auto const top = heap.front();
+    position[top.idx] = -1;
+
+    heap.front() = heap.back();
+    heap.pop_back();
+    if (!heap.empty())
+        sift_down(0);
+
+    return {top.priority, top.idx};
+}
+
+void IndexedHeap::sift_up(std::size_t i) {
+    auto const entry = heap[i];
+
+    while (i > 0) {
+        auto const parent = (i - 1) / arity;
+        if (!(entry < heap[parent]))
+            break;
+        heap[i] = heap[parent];
+        position[heap[i].idx] = static_cast<int>(i);
+        i = parent;
+    }
+
+    heap[i] = entry;
+    position[entry.idx] = static_cast<int>(i);
+}
+
+void IndexedHeap::sift_down(std::size_t i) {
+    auto const entry = heap[i];
+    auto const n = heap.size();
+
+    while (true) {
+        auto const first = i * arity + 1;
+        if (first >= n)
+            break;
+
+        // Find the smallest child.
+        auto best = first;
+        auto const last = first + arity < n ? first + arity : n;
+        for (auto c = first + 1; c < last; ++c) {
+            if (heap[c] < heap[best])
+                best = c;
+        }
+
+        if (!(heap[best] < entry))
+            break;
+        heap[i] = heap[best];
+        position[heap[i].idx] = static_cast<int>(i);
+        i = best;
+    }
+
+    heap[i] = entry;
+    position[entry.idx] = static_cast<int>(i);
+}
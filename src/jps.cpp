@@ -0,0 +1,135 @@
+#include "jps.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "grid_metrics.h"
+
+namespace jps {
+
+bool has_forced_neighbor(const Grid& grid, int x, int y, int dx, int dy) {
+    if constexpr (diagonal_movement) {
+        if (dx != 0 && dy != 0)
+            return (grid.open(x - dx, y + dy) && !grid.open(x - dx, y)) ||
+                   (grid.open(x + dx, y - dy) && !grid.open(x, y - dy));
+        if (dx != 0)
+            return (grid.open(x + dx, y + 1) && !grid.open(x, y + 1)) ||
+                   (grid.open(x + dx, y - 1) && !grid.open(x, y - 1));
+        return (grid.open(x + 1, y + dy) && !grid.open(x + 1, y)) ||
+               (grid.open(x - 1, y + dy) && !grid.open(x - 1, y));
+    } else {
+        // A cell is forced if one can turn into a side that was blocked one step earlier.
+        if (dx != 0)
+            return (grid.open(x, y - 1) && !grid.open(x - dx, y - 1)) ||
+                   (grid.open(x, y + 1) && !grid.open(x - dx, y + 1));
+        return (grid.open(x - 1, y) && !grid.open(x - 1, y - dy)) ||
+               (grid.open(x + 1, y) && !grid.open(x + 1, y - dy));
+    }
+}
+
+int jump(const Grid& grid, int x, int y, int dx, int dy, int goal) {
+    while (true) {
+        x += dx;
+        y += dy;
+        if (!grid.open(x, y))
+            return -1;
+
+        auto const idx = grid.index(x, y);
+        if (idx == goal || has_forced_neighbor(grid, x, y, dx, dy))
+            return idx;
+
+        // Stop where a jump in one of the straight components finds something.
+        if constexpr (diagonal_movement) {
+            if (dx != 0 && dy != 0 &&
+                (jump(grid, x, y, dx, 0, goal) != -1 || jump(grid, x, y, 0, dy, goal) != -1))
+                return idx;
+        } else {
+            if (dy != 0 &&
+                (jump(grid, x, y, -1, 0, goal) != -1 || jump(grid, x, y, 1, 0, goal) != -1))
+                return idx;
+        }
+    }
+}
+
+void JumpTable::build(const Grid& grid) {
+    w = grid.width();
+    dist.assign(static_cast<std::size_t>(grid.size()) * max_neighbors, 0);
+
+    // Vertical jumps (4-connected) and diagonal jumps (8-connected) depend on the distances of the
+    // directions before them.
+    for (auto dir = 0; dir < max_neighbors; ++dir)
+        build_direction(grid, dir);
+}
+
+void JumpTable::build_direction(const Grid& grid, int dir) {
+    auto const dx = directions[dir].dx;
+    auto const dy = directions[dir].dy;
+
+    // Returns true if the cell (x, y), entered with direction (dx, dy), is a jump point.
+    auto const is_jump_point = [&](int x, int y) {
+        if (has_forced_neighbor(grid, x, y, dx, dy))
+            return true;
+
+        auto const idx = grid.index(x, y);
+        if constexpr (diagonal_movement) {
+            return dx != 0 && dy != 0 &&
+                   (distance(idx, direction_index(dx, 0)) > 0 || distance(idx, direction_index(0, dy)) > 0);
+        } else {
+            return dy != 0 &&
+                   (distance(idx, direction_index(-1, 0)) > 0 || distance(idx, direction_index(1, 0)) > 0);
+        }
+    };
+
+    // Visit the cells against the direction, so the next cell in the direction is already done.
+    auto const h = grid.height();
+    for (auto i = 0; i < h; ++i) {
+        auto const y = dy > 0 ? h - 1 - i : i;
+        for (auto j = 0; j < w; ++j) {
+            auto const x = dx > 0 ? w - 1 - j : j;
+            auto const nx = x + dx;
+            auto const ny = y + dy;
+
+            auto& d = dist[static_cast<std::size_t>(grid.index(x, y)) * max_neighbors + dir];
+            if (!grid.open(nx, ny)) {
+                d = 0;
+            } else if (is_jump_point(nx, ny)) {
+                d = 1;
+            } else {
+                auto const next = distance(grid.index(nx, ny), dir);
+                d = next > 0 ? next + 1 : next - 1;
+            }
+        }
+    }
+}
+
+int JumpTable::jump(int x, int y, int dx, int dy, int goal_x, int goal_y) const {
+    auto const idx = y * w + x;
+    auto const d = distance(idx, direction_index(dx, dy));
+    auto const reach = std::abs(d);
+
+    auto const tx = goal_x - x;
+    auto const ty = goal_y - y;
+
+    if (dx != 0 && dy != 0) {
+        // Stop on the diagonal where the goal is straight ahead.
+        if (sign(tx) == dx && sign(ty) == dy) {
+            auto const m = std::min(std::abs(tx), std::abs(ty));
+            if (m <= reach)
+                return idx + m * (dy * w + dx);
+        }
+    } else if (dx != 0) {
+        if (ty == 0 && sign(tx) == dx && std::abs(tx) <= reach)
+            return idx + tx;
+    } else if (diagonal_movement) {
+        if (tx == 0 && sign(ty) == dy && std::abs(ty) <= reach)
+            return idx + ty * w;
+    } else {
+        // Stop in the row of the goal, a horizontal jump may reach it from there.
+        if (sign(ty) == dy && std::abs(ty) <= reach)
+            return idx + ty * w;
+    }
+
+    return d > 0 ? idx + d * (dy * w + dx) : -1;
+}
+
+}  // namespace jps
@@ -1,12 +1,15 @@
 #include "maze.h"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <limits>
-#include <map>
 #include <random>
+#include <thread>
 
 void Node::debug_print() const {
     std::cout << "x: "
@@ -21,12 +24,15 @@ void Node::debug_print() const {
               << std::endl;
 }
 
-Maze::Maze(bool random, int width, int height, int prob) : w{width}, h{height} {
+Maze::Maze(bool random, int width, int height, int prob)
+    : Maze(random, width, height, prob, std::random_device{}()) {}
+
+Maze::Maze(bool random, int width, int height, int prob, std::uint32_t seed)
+    : w{width}, h{height}, grid{width, height} {
     assert(width > 0);
     assert(height > 0);
 
-    std::random_device dev;
-    std::mt19937 rng(dev());
+    std::mt19937 rng(seed);
     std::uniform_int_distribution<std::mt19937::result_type> dist_passable(0, prob);
     std::uniform_int_distribution<std::mt19937::result_type> dist_width(0, width - 1);
     std::uniform_int_distribution<std::mt19937::result_type> dist_height(0, height - 1);
@@ -37,41 +43,79 @@ Maze::Maze(bool random, int width, int height, int prob) : w{width}, h{height} {
     int const end_y = dist_height(rng);
     int const end_x = dist_width(rng);
 
-    auto counter = 0;
-
-    for (auto x = 0; x < width; ++x) {
-        maze.push_back(std::vector<Node>{});
-        for (auto y = 0; y < height; ++y) {
-            auto const start = x == start_x && y == start_y;
-            auto const end = x == end_x && y == end_y;
-            auto const passable = !(random && dist_passable(rng) == 0 && !start && !end);
-
-            maze[x].push_back(Node{
-                counter++,
-                x,
-                y,
-                start,
-                end,
-                passable});
+    start_idx = grid.index(start_x, start_y);
+    end_idx = grid.index(end_x, end_y);
+
+    if (!random)
+        return;
+
+    for (auto y = 0; y < height; ++y) {
+        for (auto x = 0; x < width; ++x) {
+            auto const idx = grid.index(x, y);
+            if (idx != start_idx && idx != end_idx && dist_passable(rng) == 0)
+                grid.set_passable(x, y, false);
         }
     }
+}
+
+Maze Maze::generate(generators::Algorithm algorithm, int width, int height, std::uint32_t seed) {
+    Maze maze(false, width, height, 0, seed);
+    generators::generate(algorithm, maze.grid, seed);
 
-    start = maze[start_x][start_y];
-    end = maze[end_x][end_y];
+    // The rooms lie on even coordinates.
+    maze.start_idx = maze.grid.index(0, 0);
+    maze.end_idx = maze.grid.index((width - 1) & ~1, (height - 1) & ~1);
+    return maze;
+}
+
+Maze::Maze(Grid cells, int start, int end)
+    : w{cells.width()}, h{cells.height()}, grid{std::move(cells)}, start_idx{start}, end_idx{end} {}
+
+Maze Maze::load(const std::string& path) {
+    auto contents = maze_file::load(path);
+    return Maze(std::move(contents.grid), contents.start, contents.end);
+}
+
+void Maze::save(const std::string& path) const {
+    maze_file::save(path, grid, start_idx, end_idx);
+}
+
+Node Maze::get_node(int idx) const {
+    auto const x = grid.x_of(idx);
+    auto const y = grid.y_of(idx);
+
+    return Node{
+        idx,
+        x,
+        y,
+        idx == start_idx,
+        idx == end_idx,
+        grid.passable(x, y)};
 }
 
 void Maze::set_start(int x, int y) {
-    maze[start.x][start.y].start = false;
-    maze[x][y].start = true;
-    maze[x][y].passable = true;
-    start = maze[x][y];
+    set_passable(x, y, true);
+    start_idx = grid.index(x, y);
 }
 
 void Maze::set_end(int x, int y) {
-    maze[end.x][end.y].end = false;
-    maze[x][y].end = true;
-    maze[x][y].passable = true;
-    end = maze[x][y];
+    set_passable(x, y, true);
+    end_idx = grid.index(x, y);
+}
+
+void Maze::set_passable(int x, int y, bool passable) {
+    if (grid.passable(x, y) == passable)
+        return;
+
+    grid.set_passable(x, y, passable);
+    jump_table_dirty = true;
+    if (hierarchy_built)
+        hierarchy.invalidate(x, y);
+    planner.invalidate(grid.index(x, y));
+    if (passable)
+        components.open(grid, grid.index(x, y));
+    else
+        components.close(grid, grid.index(x, y));
 }
 
 void Maze::debug_print() {
@@ -84,11 +128,12 @@ void Maze::debug_print() {
     for (auto y = 0; y < h; ++y) {
         std::cout << "// ";
         for (auto x = 0; x < w; ++x) {
-            if (maze[x][y].start)
+            auto const idx = grid.index(x, y);
+            if (idx == start_idx)
                 std::cout << "s ";
-            else if (maze[x][y].end)
+            else if (idx == end_idx)
                 std::cout << "x ";
-            else if (maze[x][y].passable)
+            else if (grid.passable(x, y))
                 std::cout << "_ ";
             else
                 std::cout << "o ";
@@ -104,326 +149,715 @@ void Maze::debug_print() {
     std::cout << std::endl;
 }
 
-std::vector<Node> Maze::get_neighbors(const Node& node) {
-    std::vector<Node> neighbors;
+void Maze::clear_maze() {
+    grid.fill(true);
+    jump_table_dirty = true;
+    hierarchy_built = false;
+    planner.reset();
+    components.invalidate();
+}
 
-    auto left = node.x > 0;
-    auto right = node.x < (w - 1);
-    auto up = node.y > 0;
-    auto down = node.y < (h - 1);
+SearchTrace Maze::bfs() {
+    SearchTrace trace{sink};  // Every cell visited.
+    if (reject_unreachable(trace, "BFS"))
+        return trace;
+    auto& stats = trace.stats();
 
-    // Check left
-    if (left && maze[node.x - 1][node.y].passable)
-        neighbors.push_back(maze[node.x - 1][node.y]);
+    // The frontier buffer of the workspace is used as queue, every cell is enqueued at most once.
+    workspace.prepare(grid.size());
+    auto& queue = workspace.frontier;
+    std::size_t head = 0;
 
-    // Check right
-    if (right && maze[node.x + 1][node.y].passable)
-        neighbors.push_back(maze[node.x + 1][node.y]);
+    workspace.visit(start_idx, 0, start_idx);
+    queue.push_back(start_idx);
 
-    // Check up
-    if (up && maze[node.x][node.y - 1].passable)
-        neighbors.push_back(maze[node.x][node.y - 1]);
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
 
-    // Check down
-    if (down && maze[node.x][node.y + 1].passable)
-        neighbors.push_back(maze[node.x][node.y + 1]);
+    while (head < queue.size()) {
+        stats.peak_frontier = std::max(stats.peak_frontier, queue.size() - head);
 
-    // /// Diagonal movement
-    // // Check top left
-    // if (up && left && maze[node.x - 1][node.y - 1].passable)
-    //     neighbors.push_back(maze[node.x - 1][node.y - 1]);
+        // Get the current node and check if it is the end node.
+        auto const node = queue[head++];
+        ++stats.pops;
+        trace.add_visited(node);
+        if (node == end_idx)
+            break;
 
-    // // Check top right
-    // if (up && right && maze[node.x + 1][node.y - 1].passable)
-    //     neighbors.push_back(maze[node.x + 1][node.y - 1]);
+        // Check for unvisited neighbors. If there are any, push them to the back of the queue.
+        ++stats.expanded;
+        auto const d = workspace.distance(node) + 1;
+        grid.for_each_neighbor(node, [&](int neighbor) {
+            if (!workspace.visited(neighbor)) {
+                workspace.visit(neighbor, d, node);
+                queue.push_back(neighbor);
+                ++stats.generated;
+                ++stats.pushes;
+            }
+        });
+    }
 
-    // // Check bottom left
-    // if (down && left && maze[node.x - 1][node.y + 1].passable)
-    //     neighbors.push_back(maze[node.x - 1][node.y + 1]);
+    finish_search(trace, "BFS", t1, workspace.distance(end_idx));
+    return trace;
+}
 
-    // // Check bottom right
-    // if (down && right && maze[node.x + 1][node.y + 1].passable)
-    //     neighbors.push_back(maze[node.x + 1][node.y + 1]);
+SearchTrace Maze::parallel_bfs(unsigned threads) {
+    SearchTrace trace{sink};  // Every cell visited.
+    if (reject_unreachable(trace, "Parallel BFS"))
+        return trace;
+    auto& workers = thread_pool(threads);
 
-    return neighbors;
-}
+    workspace.prepare(grid.size());
 
-void Maze::clear_maze() {
-    for (auto& col : maze) {
-        for (auto& n : col) {
-            n.passable = true;
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    parallel.run(grid, workspace, workers, start_idx, end_idx, trace);
+
+    // Reconstruct the path, the start is its own predecessor.
+    if (workspace.visited(end_idx)) {
+        auto cur = end_idx;
+        trace.add_path(cur);
+        while (cur != workspace.parent_of(cur)) {
+            cur = workspace.parent_of(cur);
+            trace.add_path(cur);
         }
+        trace.reverse_path();
     }
-}
-
-std::deque<Node> Maze::bfs() {
-    std::deque<Node> visited_nodes;  // List of all nodes visited.
 
-    std::map<int, bool> visited;  // Maps node id -> node already visited.
-    std::list<Node> queue;        // List of nodes that need to be processed.
+    finish_search(trace, "Parallel BFS", t1, workspace.distance(end_idx));
+    return trace;
+}
 
-    visited[start.id] = true;
-    queue.push_back(start);
+SearchTrace Maze::wavefront_bfs() {
+    SearchTrace trace;  // Only the path.
+    if (reject_unreachable(trace, "Wavefront BFS"))
+        return trace;
+    auto& stats = trace.stats();
 
     // Take the first timestamp.
-    auto t1 = std::chrono::high_resolution_clock::now();
+    auto const t1 = std::chrono::steady_clock::now();
 
-    while (!queue.empty()) {
-        // Get the current node and check if it is the end node.
-        auto const node = queue.front();
-        queue.pop_front();
-        visited_nodes.push_back(node);
-        if (node.end)
-            break;
-
-        // Check for unvisited neighbors. If there are any, push them to the back of the queue.
-        auto const neighbors = get_neighbors(node);
-        for (auto neighbor : neighbors) {
-            if (!visited[neighbor.id]) {
-                visited[neighbor.id] = true;
-                queue.push_back(neighbor);
-            }
-        }
-    }
+    auto const distance = wavefront.run(grid, start_idx, end_idx, &wavefront_path);
+    for (auto const idx : wavefront_path)
+        trace.add_path(idx);
+    auto const t2 = std::chrono::steady_clock::now();
 
-    // Take the second timestamp.
-    auto t2 = std::chrono::high_resolution_clock::now();
-    print_elapsed_time(t1, t2);
+    // Every visited cell counts as expanded and every level as one pop of the frontier. Counting
+    // the visited cells scans the bitmap, which is not part of the search time.
+    stats.expanded = wavefront.visited_count();
+    stats.generated = stats.expanded;
+    stats.pops = wavefront.level_count();
 
-    return visited_nodes;
+    finish_search(trace, "Wavefront BFS", t1 + (std::chrono::steady_clock::now() - t2), distance);
+    return trace;
 }
 
-std::deque<Node> Maze::dfs() {
-    std::deque<Node> visited_nodes;  // List of all nodes visited.
+SearchTrace Maze::dfs() {
+    SearchTrace trace{sink};  // Every cell visited.
+    if (reject_unreachable(trace, "DFS"))
+        return trace;
+    auto& stats = trace.stats();
 
-    std::map<int, bool> visited;  // Maps node id -> node already visited.
-    std::list<Node> stack;        // List of nodes that need to be processed.
+    // The frontier buffer of the workspace is used as stack.
+    workspace.prepare(grid.size());
+    auto& stack = workspace.frontier;
 
-    visited[start.id] = true;
-    stack.push_front(start);
+    workspace.visit(start_idx, 0, start_idx);
+    stack.push_back(start_idx);
 
     // Take the first timestamp.
-    auto t1 = std::chrono::high_resolution_clock::now();
+    auto const t1 = std::chrono::steady_clock::now();
 
     while (!stack.empty()) {
+        stats.peak_frontier = std::max(stats.peak_frontier, stack.size());
+
         // Get the current node and check if it is the end node.
-        auto const node = stack.front();
-        stack.pop_front();
-        visited_nodes.push_back(node);
-        if (node.end)
+        auto const node = stack.back();
+        stack.pop_back();
+        ++stats.pops;
+        trace.add_visited(node);
+        if (node == end_idx)
             break;
 
-        // Check for unvisited neighbors. If there are any, push them to the front of the stack.
-        auto const neighbors = get_neighbors(node);
-        for (auto neighbor : neighbors) {
-            if (!visited[neighbor.id]) {
-                visited[neighbor.id] = true;
-                stack.push_front(neighbor);
+        // Check for unvisited neighbors. If there are any, push them on top of the stack.
+        ++stats.expanded;
+        auto const d = workspace.distance(node) + 1;
+        grid.for_each_neighbor(node, [&](int neighbor) {
+            if (!workspace.visited(neighbor)) {
+                workspace.visit(neighbor, d, node);
+                stack.push_back(neighbor);
+                ++stats.generated;
+                ++stats.pushes;
             }
-        }
+        });
     }
 
-    // Take the second timestamp.
-    auto t2 = std::chrono::high_resolution_clock::now();
-    print_elapsed_time(t1, t2);
-
-    return visited_nodes;
+    finish_search(trace, "DFS", t1, workspace.distance(end_idx));
+    return trace;
 }
 
-std::pair<std::deque<Node>, std::deque<Node>> Maze::dijkstra() {
-    std::deque<Node> visited_nodes;  // List of all nodes visited.
-    std::deque<Node> shortest_path;  // List of the nodes which build the shortest path.
-    Node cur;
+namespace {
+
+/// Largest amount by which the heuristics can change between two neighbors. The Manhattan, the
+/// Chebyshev and the rounded down Euclidean distance all change by at most 1 per step.
+constexpr int max_heuristic_step = 1;
 
-    std::map<int, int> distance;  // Maps node id -> distance.
-    std::map<int, Node> prev;     // Maps node id -> predecessor.
+/**
+ * Queues a cell for A*. On equal f_score the heap prefers the larger g_score, which is the node
+ * closer to the end.
+ */
+void push_open(IndexedHeap& pq, int f_score, int g_score, int idx) {
+    pq.push(f_score, idx, -g_score);
+}
+
+void push_open(BucketQueue& pq, int f_score, int, int idx) {
+    pq.push(f_score, idx);
+}
 
-    // Custom comparator for min dequeue. We only care for the first parameter, which is the
-    // distance.
-    auto comp =
-        [](std::pair<int, Node> n1, std::pair<int, Node> n2) {
-            return n1.first > n2.first;
-        };
+}  // namespace
 
-    // Min priority dequeu, storing pairs <distance, Node>.
-    std::priority_queue<std::pair<int, Node>,
-                        std::vector<std::pair<int, Node>>,
-                        decltype(comp)>
-        pq(comp);
+template <typename Queue>
+SearchTrace Maze::_dijkstra(Queue& pq) {
+    SearchTrace trace{sink};  // Every cell visited, followed by the shortest path.
+    if (reject_unreachable(trace, "Dijkstra"))
+        return trace;
+    auto& stats = trace.stats();
+    int cur{};
 
-    distance[start.id] = 0;
-    prev[start.id] = start;
-    pq.push(std::pair(0, start));
+    // The queue stores pairs <distance, node id>.
+    workspace.visit(start_idx, 0, start_idx);
+    pq.push(0, start_idx);
 
     // Take the first timestamp.
-    auto t1 = std::chrono::high_resolution_clock::now();
+    auto const t1 = std::chrono::steady_clock::now();
 
     while (!pq.empty()) {
+        stats.peak_frontier = std::max(stats.peak_frontier, pq.size());
+
         // Get the node of the queue with the shortest distance to the start.
-        auto const cur_cost = pq.top().first;
-        cur = pq.top().second;
-        pq.pop();
+        auto const [cur_cost, top] = pq.pop();
+        cur = top;
+        ++stats.pops;
+
+        // The bucket queue keeps the entries of nodes that were queued again with a lower cost,
+        // which are skipped before they count as visited.
+        if (workspace.distance(cur) < cur_cost)
+            continue;
 
         // Push this node to the visited nodes.
-        visited_nodes.push_back(cur);
+        trace.add_visited(cur);
 
         // Check if the current node is the end.
-        if (cur.end)
+        if (cur == end_idx)
             break;
 
-        // If we get a node with higher cost continue.
-        if (distance[cur.id] < cur_cost)
-            continue;
-
         // Traverse the neighbors of the current node.
-        auto neighbors = get_neighbors(cur);
-        for (auto const& n : neighbors) {
-            // If the node doesn't have an entry in distance yet, update it with infinite distance.
-            if (distance.find(n.id) == distance.end())
-                distance[n.id] = std::numeric_limits<int>::max();
-
+        ++stats.expanded;
+        grid.for_each_neighbor(cur, [&](int n) {
             // Calculate the distance, which is current distance + 1, since the edge weight is
-            // always 1 in our case.
-            auto const alt = distance[cur.id] + 1;
-
-            if (alt < distance[n.id]) {
-                distance[n.id] = alt;
-                prev[n.id] = cur;
-                pq.push(std::pair(alt, n));
+            // always 1 in our case. Unvisited nodes have an infinite distance.
+            auto const alt = cur_cost + 1;
+
+            if (alt < workspace.distance(n)) {
+                stats.generated += !workspace.visited(n);
+                workspace.visit(n, alt, cur);
+                pq.push(alt, n);
+                ++stats.pushes;
             }
-        }
+        });
     }
 
-    // Take the second timestamp.
-    auto t2 = std::chrono::high_resolution_clock::now();
-    print_elapsed_time(t1, t2);
-
-    // Reconstruct path.
-    while (true) {
-        shortest_path.push_front(cur);
-        if (cur.id == prev[cur.id].id)
-            break;
-        else
-            cur = prev[cur.id];
+    // Reconstruct path, if the end was reached.
+    if (cur == end_idx) {
+        while (true) {
+            trace.add_path(cur);
+            if (cur == workspace.parent_of(cur))
+                break;
+            else
+                cur = workspace.parent_of(cur);
+        }
+        trace.reverse_path();
     }
 
-    return std::pair(visited_nodes, shortest_path);
+    finish_search(trace, "Dijkstra", t1, workspace.distance(end_idx));
+    return trace;
 }
 
-template <typename Heuristic>
-std::pair<std::deque<Node>, std::deque<Node>> Maze::_a_star(Heuristic h) {
-    std::deque<Node> visited_nodes;
-    std::deque<Node> shortest_path;
-    Node cur;
-
-    // Maps n.id -> node preceding n on the cheapest path from start to n.
-    std::map<int, Node> came_from;
-
-    // Custom comparator for min dequeue. We only care for the first parameter, which is the
-    // distance.
-    auto comp =
-        [](std::pair<int, Node> n1, std::pair<int, Node> n2) {
-            return n1.first > n2.first;
-        };
+SearchTrace Maze::dijkstra(PriorityQueue queue) {
+    workspace.prepare(grid.size());
 
-    // Min priority dequeu, storing pairs <f_score, Node>.
-    std::priority_queue<std::pair<int, Node>,
-                        std::vector<std::pair<int, Node>>,
-                        decltype(comp)>
-        pq(comp);
-
-    // contains[node.id] is true if node is in pq.
-    std::map<int, bool> contains;
+    if (queue == PriorityQueue::Buckets) {
+        // Every edge costs 1, so the queued distances differ by at most 1.
+        workspace.buckets.reset(1);
+        return _dijkstra(workspace.buckets);
+    }
 
-    // Maps n.id -> cost of the cheapest path from start to n.
-    std::map<int, int> g_score;
-    g_score[start.id] = 0;
+    return _dijkstra(workspace.heap);
+}
 
-    // f_sccore[n.id] = g_score[n.id] + h(n).
-    std::map<int, int> f_score;
-    f_score[start.id] = h(start);
+template <typename Heuristic, typename Queue>
+SearchTrace Maze::_a_star(Heuristic h, Queue& pq) {
+    SearchTrace trace{sink};
+    if (reject_unreachable(trace, "A*"))
+        return trace;
+    auto& stats = trace.stats();
+    int cur{};
 
-    pq.push(std::pair(f_score[start.id], start));
-    contains[start.id] = true;
+    // The workspace keeps g_score and the predecessor of every node.
+    // The queue stores pairs <f_score, node id>, where f_score = g_score + h(n).
+    workspace.visit(start_idx, 0, start_idx);
+    pq.push(h(start_idx), start_idx);
 
     // Take the first timestamp.
-    auto t1 = std::chrono::high_resolution_clock::now();
+    auto const t1 = std::chrono::steady_clock::now();
 
     while (!pq.empty()) {
+        stats.peak_frontier = std::max(stats.peak_frontier, pq.size());
+
         // Get the node with the lowest f_score.
-        cur = pq.top().second;
-        pq.pop();
+        auto const [f_score, top] = pq.pop();
+        cur = top;
+        ++stats.pops;
+
+        // The bucket queue keeps the entries of nodes that were queued again with a lower g_score,
+        // which are skipped before they count as visited.
+        if (workspace.distance(cur) + h(cur) < f_score)
+            continue;
 
         // Push the current node to the visited nodes.
-        visited_nodes.push_back(cur);
+        trace.add_visited(cur);
 
-        if (cur.end)
+        if (cur == end_idx)
             break;
 
-        // If the current node doesn't have a g_score yet, set it to infinity.
-        if (g_score.find(cur.id) == g_score.end())
-            g_score[cur.id] = std::numeric_limits<int>::max();
-
         // Traverse the neighbors of the current node.
-        auto neighbors = get_neighbors(cur);
-        for (auto& n : neighbors) {
-            // If n doesn't have an entry in g_score yet, set it to inifinity.
-            if (g_score.find(n.id) == g_score.end())
-                g_score[n.id] = std::numeric_limits<int>::max();
-
+        ++stats.expanded;
+        auto const g_cur = workspace.distance(cur);
+        grid.for_each_neighbor(cur, [&](int n) {
             // The distance is always 1 in our case.
-            auto tentative_g_score = g_score[cur.id] + 1;
+            auto tentative_g_score = g_cur + 1;
 
-            if (tentative_g_score < g_score[n.id]) {
+            if (tentative_g_score < workspace.distance(n)) {
                 // We found a better path to the neighbor.
-                came_from[n.id] = cur;
-                g_score[n.id] = tentative_g_score;
-                f_score[n.id] = tentative_g_score + h(n);
-
-                if (!contains[n.id])
-                    pq.push(std::pair(f_score[n.id], n));
+                stats.generated += !workspace.visited(n);
+                workspace.visit(n, tentative_g_score, cur);
+                push_open(pq, tentative_g_score + h(n), tentative_g_score, n);
+                ++stats.pushes;
             }
+        });
+    }
+
+    // Reconstruct path, if the end was reached.
+    if (cur == end_idx) {
+        trace.add_path(cur);
+        while (cur != workspace.parent_of(cur)) {
+            cur = workspace.parent_of(cur);
+            trace.add_path(cur);
         }
+        trace.reverse_path();
     }
 
-    // Take the second timestamp.
-    auto t2 = std::chrono::high_resolution_clock::now();
-    print_elapsed_time(t1, t2);
+    finish_search(trace, "A*", t1, workspace.distance(end_idx));
+    return trace;
+}
 
-    // Reconstruct path.
-    shortest_path.push_front(cur);
-    while (came_from.find(cur.id) != came_from.end()) {
-        cur = came_from[cur.id];
-        shortest_path.push_front(cur);
+template <typename Heuristic>
+SearchTrace Maze::_a_star(Heuristic h, PriorityQueue queue) {
+    workspace.prepare(grid.size());
+
+    if (queue == PriorityQueue::Buckets) {
+        // f_score = g_score + h grows by at most the edge cost plus the change of h.
+        workspace.buckets.reset(1 + max_heuristic_step);
+        return _a_star(h, workspace.buckets);
     }
 
-    return std::pair(visited_nodes, shortest_path);
+    return _a_star(h, workspace.heap);
 }
 
-std::pair<std::deque<Node>, std::deque<Node>> Maze::a_star(Heuristics heuristic) {
+SearchTrace Maze::a_star(Heuristics heuristic, PriorityQueue queue) {
+    auto const end_x = grid.x_of(end_idx);
+    auto const end_y = grid.y_of(end_idx);
+
     switch (heuristic) {
         case Heuristics::Dijkstra:
-            return _a_star([](Node node) {
+            return _a_star([](int) {
                 return 0;
-            });
+            }, queue);
         case Heuristics::Manhattan:
-            return _a_star([this](Node node) {
-                auto dx = std::abs(node.x - end.x);
-                auto dy = std::abs(node.y - end.y);
-                return dx + dy;
-            });
+            return _a_star([this, end_x, end_y](int idx) {
+                return heuristic_distance(Heuristics::Manhattan, grid.x_of(idx) - end_x, grid.y_of(idx) - end_y);
+            }, queue);
         case Heuristics::Euclidean:
-            return _a_star([this](Node node) {
-                auto dx = std::abs(node.x - end.x);
-                auto dy = std::abs(node.y - end.y);
-                return std::sqrt(dx * dx + dy * dy);
+            return _a_star([this, end_x, end_y](int idx) {
+                return heuristic_distance(Heuristics::Euclidean, grid.x_of(idx) - end_x, grid.y_of(idx) - end_y);
+            }, queue);
+    }
+    return {};
+}
+
+template <typename Jump>
+SearchTrace Maze::_jps(Jump jump, const char* algorithm) {
+    SearchTrace trace{sink};
+    if (reject_unreachable(trace, algorithm))
+        return trace;
+    auto& stats = trace.stats();
+    auto found = false;
+
+    auto const end_x = grid.x_of(end_idx);
+    auto const end_y = grid.y_of(end_idx);
+
+    auto const h = [this, end_x, end_y](int idx) {
+        return grid_distance(grid.x_of(idx) - end_x, grid.y_of(idx) - end_y);
+    };
+
+    // The workspace keeps g_score and the predecessor of every jump point.
+    // The queue stores pairs <f_score, node id>, where f_score = g_score + h(n).
+    workspace.prepare(grid.size());
+    auto& pq = workspace.heap;
+
+    workspace.visit(start_idx, 0, start_idx);
+    pq.push(h(start_idx), start_idx);
+
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    while (!pq.empty()) {
+        stats.peak_frontier = std::max(stats.peak_frontier, pq.size());
+
+        auto const cur = pq.pop().second;
+        ++stats.pops;
+        trace.add_visited(cur);
+
+        if (cur == end_idx) {
+            found = true;
+            break;
+        }
+
+        // The direction in which the current node was entered decides where to jump next.
+        auto const x = grid.x_of(cur);
+        auto const y = grid.y_of(cur);
+        auto const prev = workspace.parent_of(cur);
+        auto const g_cur = workspace.distance(cur);
+        ++stats.expanded;
+
+        jps::for_each_direction(grid, x, y, sign(x - grid.x_of(prev)), sign(y - grid.y_of(prev)), [&](int dx, int dy) {
+            auto const n = jump(x, y, dx, dy);
+            if (n < 0)
+                return;
+
+            // Jumps are straight lines, so the cost is the number of steps.
+            auto const tentative_g_score = g_cur + std::max(std::abs(grid.x_of(n) - x), std::abs(grid.y_of(n) - y));
+            if (tentative_g_score < workspace.distance(n)) {
+                stats.generated += !workspace.visited(n);
+                workspace.visit(n, tentative_g_score, cur);
+                push_open(pq, tentative_g_score + h(n), tentative_g_score, n);
+                ++stats.pushes;
+            }
+        });
+    }
+
+    if (!found) {
+        finish_search(trace, algorithm, t1, -1);
+        return trace;
+    }
+
+    // Reconstruct path, walking every cell between two jump points.
+    auto cur = end_idx;
+    trace.add_path(cur);
+    while (cur != workspace.parent_of(cur)) {
+        auto const prev = workspace.parent_of(cur);
+        auto const step = sign(grid.y_of(prev) - grid.y_of(cur)) * w + sign(grid.x_of(prev) - grid.x_of(cur));
+        while (cur != prev) {
+            cur += step;
+            trace.add_path(cur);
+        }
+    }
+    trace.reverse_path();
+
+    finish_search(trace, algorithm, t1, workspace.distance(end_idx));
+    return trace;
+}
+
+SearchTrace Maze::jps() {
+    return _jps([this](int x, int y, int dx, int dy) {
+        return jps::jump(grid, x, y, dx, dy, end_idx);
+    }, "JPS");
+}
+
+SearchTrace Maze::jps_plus() {
+    if (jump_table_dirty) {
+        jump_table.build(grid);
+        jump_table_dirty = false;
+    }
+
+    auto const end_x = grid.x_of(end_idx);
+    auto const end_y = grid.y_of(end_idx);
+
+    return _jps([this, end_x, end_y](int x, int y, int dx, int dy) {
+        return jump_table.jump(x, y, dx, dy, end_x, end_y);
+    }, "JPS+");
+}
+
+void Maze::add_bidirectional_path(SearchTrace& trace, int meet) const {
+    // Walk from the meeting cell back to the start and reverse, then on to the end.
+    auto cur = meet;
+    trace.add_path(cur);
+    while (cur != workspace.parent_of(cur)) {
+        cur = workspace.parent_of(cur);
+        trace.add_path(cur);
+    }
+    trace.reverse_path();
+
+    cur = meet;
+    while (cur != backward_workspace.parent_of(cur)) {
+        cur = backward_workspace.parent_of(cur);
+        trace.add_path(cur);
+    }
+}
+
+SearchTrace Maze::bidirectional_bfs() {
+    SearchTrace trace{sink};
+    if (reject_unreachable(trace, "Bidirectional BFS"))
+        return trace;
+    auto& stats = trace.stats();
+    auto best = SearchWorkspace::infinity;  // Length of the shortest path found so far.
+    auto meet = -1;                         // Cell where the shortest path found so far meets.
+
+    // The frontier buffers of both workspaces are used as queues, each level is a slice of them.
+    workspace.prepare(grid.size());
+    backward_workspace.prepare(grid.size());
+    std::size_t forward_head = 0;
+    std::size_t backward_head = 0;
+    auto forward = false;  // True if the last level was expanded from the start.
+
+    workspace.visit(start_idx, 0, start_idx);
+    workspace.frontier.push_back(start_idx);
+    backward_workspace.visit(end_idx, 0, end_idx);
+    backward_workspace.frontier.push_back(end_idx);
+
+    if (start_idx == end_idx) {
+        trace.add_visited(start_idx);
+        best = 0;
+        meet = start_idx;
+    }
+
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    while (meet < 0 && forward_head < workspace.frontier.size() &&
+           backward_head < backward_workspace.frontier.size()) {
+        // Expand one whole level of the side with the smaller frontier, alternating on ties.
+        // Finishing the level makes sure that the shortest of all paths meeting in it is found.
+        auto const forward_size = workspace.frontier.size() - forward_head;
+        auto const backward_size = backward_workspace.frontier.size() - backward_head;
+        forward = forward_size < backward_size || (forward_size == backward_size && !forward);
+        auto& self = forward ? workspace : backward_workspace;
+        auto& other = forward ? backward_workspace : workspace;
+        auto& head = forward ? forward_head : backward_head;
+
+        stats.peak_frontier = std::max(stats.peak_frontier, forward_size + backward_size);
+
+        auto const level_end = self.frontier.size();
+        while (head < level_end) {
+            auto const node = self.frontier[head++];
+            ++stats.pops;
+            ++stats.expanded;
+            trace.add_visited(node, !forward);
+
+            auto const d = self.distance(node) + 1;
+            grid.for_each_neighbor(node, [&](int n) {
+                if (self.visited(n))
+                    return;
+
+                self.visit(n, d, node);
+                self.frontier.push_back(n);
+                ++stats.generated;
+                ++stats.pushes;
+
+                if (other.visited(n) && d + other.distance(n) < best) {
+                    best = d + other.distance(n);
+                    meet = n;
+                }
             });
+        }
+    }
+
+    if (meet >= 0)
+        add_bidirectional_path(trace, meet);
+
+    finish_search(trace, "Bidirectional BFS", t1, meet >= 0 ? best : -1);
+    return trace;
+}
+
+SearchTrace Maze::bidirectional_a_star() {
+    SearchTrace trace{sink};
+    if (reject_unreachable(trace, "Bidirectional A*"))
+        return trace;
+    auto& stats = trace.stats();
+    auto best = SearchWorkspace::infinity;  // Length of the shortest path found so far.
+    auto meet = -1;                         // Cell where the shortest path found so far meets.
+
+    auto const start_x = grid.x_of(start_idx);
+    auto const start_y = grid.y_of(start_idx);
+    auto const end_x = grid.x_of(end_idx);
+    auto const end_y = grid.y_of(end_idx);
+
+    // Both heuristics are consistent, the forward search estimates the distance to the end and the
+    // backward search the distance to the start.
+    auto const h = [this](int idx, int x, int y) {
+        return grid_distance(grid.x_of(idx) - x, grid.y_of(idx) - y);
+    };
+
+    // Each queue stores pairs <f_score, node id> in the heap of its workspace.
+    workspace.prepare(grid.size());
+    backward_workspace.prepare(grid.size());
+    auto& forward_pq = workspace.heap;
+    auto& backward_pq = backward_workspace.heap;
+    auto forward = false;  // True if the last node was expanded from the start.
+
+    workspace.visit(start_idx, 0, start_idx);
+    forward_pq.push(h(start_idx, end_x, end_y), start_idx);
+    backward_workspace.visit(end_idx, 0, end_idx);
+    backward_pq.push(h(end_idx, start_x, start_y), end_idx);
+
+    if (start_idx == end_idx) {
+        best = 0;
+        meet = start_idx;
     }
+
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    while (!forward_pq.empty() && !backward_pq.empty()) {
+        // The smallest f_score of each queue is a lower bound for every path not found yet.
+        if (best <= std::max(forward_pq.top().first, backward_pq.top().first))
+            break;
+
+        // Expand the side with the smaller queue, alternating on ties.
+        forward = forward_pq.size() < backward_pq.size() ||
+                  (forward_pq.size() == backward_pq.size() && !forward);
+        auto& self = forward ? workspace : backward_workspace;
+        auto& other = forward ? backward_workspace : workspace;
+        auto& pq = forward ? forward_pq : backward_pq;
+        auto const target_x = forward ? end_x : start_x;
+        auto const target_y = forward ? end_y : start_y;
+
+        stats.peak_frontier = std::max(stats.peak_frontier, forward_pq.size() + backward_pq.size());
+
+        auto const cur = pq.pop().second;
+        ++stats.pops;
+        ++stats.expanded;
+        trace.add_visited(cur, !forward);
+
+        auto const g_cur = self.distance(cur);
+        grid.for_each_neighbor(cur, [&](int n) {
+            auto const tentative_g_score = g_cur + 1;
+            if (tentative_g_score >= self.distance(n))
+                return;
+
+            stats.generated += !self.visited(n);
+            self.visit(n, tentative_g_score, cur);
+            push_open(pq, tentative_g_score + h(n, target_x, target_y), tentative_g_score, n);
+            ++stats.pushes;
+
+            if (other.visited(n) && tentative_g_score + other.distance(n) < best) {
+                best = tentative_g_score + other.distance(n);
+                meet = n;
+            }
+        });
+    }
+
+    if (meet >= 0)
+        add_bidirectional_path(trace, meet);
+
+    finish_search(trace, "Bidirectional A*", t1, meet >= 0 ? best : -1);
+    return trace;
+}
+
+SearchTrace Maze::hpa_star() {
+    SearchTrace trace{sink};
+    if (reject_unreachable(trace, "HPA*"))
+        return trace;
+
+    // Building the abstract graph is not part of the search time.
+    if (!hierarchy_built) {
+        hierarchy.build(grid, thread_pool(0));
+        hierarchy_built = true;
+    } else if (hierarchy.dirty_size() != 0) {
+        hierarchy.update(grid, thread_pool(0));
+    }
+
+    workspace.prepare(grid.size());
+
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    auto const cost = hierarchy.find_path(grid, workspace, start_idx, end_idx, trace);
+
+    finish_search(trace, "HPA*", t1, cost);
+    return trace;
 }
 
-template <typename Clock>
-void Maze::print_elapsed_time(std::chrono::time_point<Clock> t1, std::chrono::time_point<Clock> t2) {
-    auto ms_int = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+SearchTrace Maze::d_star_lite() {
+    SearchTrace trace{sink};
+    if (reject_unreachable(trace, "D* Lite"))
+        return trace;
 
-    std::cout << "It took " << ms_int.count() << "ms to find the end." << std::endl;
-}
\ No newline at end of file
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    auto const cost = planner.plan(grid, start_idx, end_idx, trace);
+
+    finish_search(trace, "D* Lite", t1, cost);
+    return trace;
+}
+
+PathBatch Maze::batch_a_star(const std::vector<Query>& queries, unsigned threads) {
+    // The component index is not thread-safe, so unreachable queries are sorted out up front and
+    // replaced by an invalid query, which gets an empty path without a search.
+    reachable.assign(queries.begin(), queries.end());
+    for (auto& q : reachable) {
+        auto const valid = q.start >= 0 && q.end >= 0 && q.start < grid.size() && q.end < grid.size();
+        if (!valid || !components.connected(grid, q.start, q.end))
+            q = Query{-1, -1};
+    }
+
+    return batch.run(grid, thread_pool(threads), reachable);
+}
+
+ThreadPool& Maze::thread_pool(unsigned threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!pool || pool->size() != threads)
+        pool = std::make_unique<ThreadPool>(threads);
+    return *pool;
+}
+
+const DistanceField& Maze::distance_field(const std::vector<int>& goals, bool with_directions) {
+    field.compute(grid, goals, with_directions);
+    return field;
+}
+
+void Maze::finish_search(SearchTrace& trace, const char* algorithm, std::chrono::steady_clock::time_point t1, int cost) const {
+    auto const t2 = std::chrono::steady_clock::now();
+
+    auto& stats = trace.stats();
+    stats.wall_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+    stats.path_length = trace.path_size();
+    stats.path_cost = cost == SearchWorkspace::infinity ? -1 : cost;
+
+    if (observer)
+        observer(algorithm, stats);
+}
+
+bool Maze::reject_unreachable(SearchTrace& trace, const char* algorithm) {
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    if (components.connected(grid, start_idx, end_idx))
+        return false;
+
+    finish_search(trace, algorithm, t1, -1);
+    return true;
+}
@@ -0,0 +1,203 @@
+#include "maze_file.h"
+
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace maze_file {
+
+namespace {
+
+/// The words of the plane are stored little-endian, which big-endian hosts would have to swap.
+bool little_endian() {
+    std::uint16_t const one = 1;
+    unsigned char first{};
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+/**
+ * Throws if the host cannot use the words of the plane as they are.
+ */
+void check_host() {
+    if (!little_endian())
+        throw std::runtime_error("Maze files are only supported on little-endian hosts");
+}
+
+/**
+ * Throws if the rows or columns of a grid cannot be counted with int.
+ */
+void check_size(std::uint64_t width, std::uint64_t height) {
+    if (width > INT_MAX || height > INT_MAX)
+        throw std::runtime_error("Maze is too large");
+}
+
+/**
+ * Checks that a grid can be written before its file is created, so a rejected grid leaves an
+ * existing file as it was.
+ */
+std::ofstream create_file(const std::string& path, int width, int height) {
+    check_host();
+    check_size(static_cast<std::uint64_t>(width), static_cast<std::uint64_t>(height));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Failed to create " + path);
+    return out;
+}
+
+/**
+ * The bytes of a whole file, released together with the last grid viewing them.
+ */
+struct Mapping {
+    std::shared_ptr<void> owner;
+    unsigned char* data{};
+    std::uint64_t size{};
+};
+
+#ifdef _WIN32
+
+Mapping map_file(const std::string& path) {
+    // Without mmap the file is read at once, into words so the plane stays aligned.
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        throw std::runtime_error("Failed to open " + path);
+
+    auto const size = static_cast<std::uint64_t>(in.tellg());
+    auto words = std::make_shared<std::vector<std::uint64_t>>((size + 7) / 8);
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(words->data()), static_cast<std::streamsize>(size)))
+        throw std::runtime_error("Failed to read " + path);
+
+    auto* data = reinterpret_cast<unsigned char*>(words->data());
+    return {std::move(words), data, size};
+}
+
+#else
+
+Mapping map_file(const std::string& path) {
+    auto const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open " + path);
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to read " + path);
+    }
+    auto const size = static_cast<std::uint64_t>(info.st_size);
+
+    // A private writable mapping lets the grid change cells without changing the file.
+    auto* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        throw std::runtime_error("Failed to map " + path);
+
+    auto owner = std::shared_ptr<void>(addr, [size](void* p) { ::munmap(p, size); });
+    return {std::move(owner), static_cast<unsigned char*>(addr), size};
+}
+
+#endif
+
+}  // namespace
+
+Writer::Writer(const std::string& path, int width, int height)
+    : out(create_file(path, width, height)), w{width}, h{height}, stride{(width + 63) / 64} {
+    Header header{};
+    header.magic = magic;
+    header.version = version;
+    header.header_size = sizeof(Header);
+    header.width = static_cast<std::uint64_t>(width);
+    header.height = static_cast<std::uint64_t>(height);
+    header.words_per_row = static_cast<std::uint64_t>(stride);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void Writer::write_row(const std::uint64_t* row) {
+    out.write(reinterpret_cast<const char*>(row), static_cast<std::streamsize>(stride * sizeof(std::uint64_t)));
+    ++rows;
+}
+
+void Writer::finish(std::uint64_t start, std::uint64_t end) {
+    if (rows != h)
+        throw std::runtime_error("Not every row of the maze was written");
+
+    auto const trailer = Trailer{start, end};
+    out.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+    out.close();
+    if (!out)
+        throw std::runtime_error("Failed to write the maze");
+}
+
+void check_header(const Header& header, std::uint64_t file_size, const std::string& path) {
+    check_host();
+    if (header.magic != magic)
+        throw std::runtime_error(path + " is not a maze file");
+    if (header.version != version)
+        throw std::runtime_error(path + " has unsupported version " + std::to_string(header.version));
+
+    check_size(header.width, header.height);
+    if (header.header_size < sizeof(Header) || header.header_size % sizeof(std::uint64_t) != 0 ||
+        header.words_per_row != (header.width + 63) / 64 ||
+        file_size != header.header_size + plane_bytes(header) + sizeof(Trailer))
+        throw std::runtime_error(path + " is damaged");
+}
+
+void check_trailer(const Header& header, const Trailer& trailer, const std::string& path) {
+    auto const cells = header.width * header.height;
+    if (trailer.start >= cells || trailer.end >= cells)
+        throw std::runtime_error(path + " is damaged");
+}
+
+Contents load(const std::string& path) {
+    auto mapping = map_file(path);
+
+    Header header{};
+    if (mapping.size < sizeof(Header))
+        throw std::runtime_error(path + " is not a maze file");
+    std::memcpy(&header, mapping.data, sizeof(header));
+    check_header(header, mapping.size, path);
+
+    // A Grid indexes its cells with int.
+    if (header.height != 0 && header.width > INT_MAX / header.height)
+        throw std::runtime_error(path + " is too large to load, use TiledGrid");
+
+    // Only the header and the trailer are read, the plane is used as it is.
+    Trailer trailer{};
+    std::memcpy(&trailer, mapping.data + header.header_size + plane_bytes(header), sizeof(trailer));
+    check_trailer(header, trailer, path);
+
+    auto* plane = reinterpret_cast<std::uint64_t*>(mapping.data + header.header_size);
+
+    // Grid relies on zero bits past the width, which only the last word of a row can hold.
+    if (header.width % 64 != 0) {
+        auto const padding = ~std::uint64_t{0} << (header.width % 64);
+        auto const stride = header.words_per_row;
+        for (std::uint64_t y = 0; y < header.height; ++y) {
+            if ((plane[y * stride + stride - 1] & padding) != 0)
+                throw std::runtime_error(path + " is damaged");
+        }
+    }
+
+    return {Grid::view(static_cast<int>(header.width), static_cast<int>(header.height), plane, std::move(mapping.owner)),
+            static_cast<int>(trailer.start), static_cast<int>(trailer.end)};
+}
+
+void save(const std::string& path, const Grid& grid, int start, int end) {
+    Writer writer(path, grid.width(), grid.height());
+    for (auto y = 0; y < grid.height(); ++y)
+        writer.write_row(grid.row(y));
+    writer.finish(start, end);
+}
+
+}  // namespace maze_file
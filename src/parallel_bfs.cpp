@@ -0,0 +1,230 @@
+#include "parallel_bfs.h"
+
+#include <algorithm>
+#include <bitset>
+#include <utility>
+
+namespace {
+
+/// Frontier cells per chunk of a top-down step.
+constexpr std::size_t top_down_grain = 512;
+
+/// Bitmap words, 64 cells each, per chunk of a bottom-up step.
+constexpr std::size_t bottom_up_grain = 32;
+
+/// Rows per chunk when the bitmaps are prepared.
+constexpr std::size_t row_grain = 64;
+
+/// Switch to bottom-up once the frontier is larger than the unvisited cells / alpha.
+constexpr std::size_t alpha = 14;
+
+/// Switch back to top-down once the frontier shrinks and is smaller than the passable cells / beta.
+constexpr std::size_t beta = 24;
+
+constexpr auto relaxed = std::memory_order_relaxed;
+
+bool test(const std::atomic<std::uint64_t>* bits, int idx) {
+    return (bits[idx >> 6].load(relaxed) >> (idx & 63)) & 1u;
+}
+
+/**
+ * Sets the bit of idx and returns true if it was not set before.
+ */
+bool claim(std::atomic<std::uint64_t>* bits, int idx) {
+    auto const bit = std::uint64_t{1} << (idx & 63);
+    auto& word = bits[idx >> 6];
+    if (word.load(relaxed) & bit)
+        return false;
+    return !(word.fetch_or(bit, relaxed) & bit);
+}
+
+int count_trailing_zeros(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#else
+    auto n = 0;
+    while (!(v & 1u)) {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+}  // namespace
+
+std::size_t ParallelBfs::prepare(const Grid& grid, ThreadPool& pool) {
+    words = (static_cast<std::size_t>(grid.size()) + 63) / 64;
+    if (capacity < words) {
+        visited = std::make_unique<std::atomic<std::uint64_t>[]>(words);
+        in_frontier = std::make_unique<std::atomic<std::uint64_t>[]>(words);
+        capacity = words;
+    }
+
+    pool.parallel_for(words, bottom_up_grain * 64, [this](std::size_t begin, std::size_t end, unsigned) {
+        for (auto k = begin; k < end; ++k) {
+            visited[k].store(~std::uint64_t{0}, relaxed);
+            in_frontier[k].store(0, relaxed);
+        }
+    });
+
+    // Clear the bits of the passable cells. The rows of the grid are word aligned, the bitmap is
+    // not, so a word of a row is split over two words of the bitmap.
+    std::atomic<std::size_t> passable{0};
+    auto const w = static_cast<std::size_t>(grid.width());
+    pool.parallel_for(grid.height(), row_grain, [&](std::size_t begin, std::size_t end, unsigned) {
+        std::size_t count = 0;
+        for (auto y = begin; y < end; ++y) {
+            auto const* row = grid.row(static_cast<int>(y));
+            for (auto j = 0; j < grid.words_per_row(); ++j) {
+                auto const bits = row[j];
+                if (!bits)
+                    continue;
+                count += std::bitset<64>(bits).count();
+
+                auto const pos = y * w + 64 * static_cast<std::size_t>(j);
+                auto const shift = pos & 63;
+                visited[pos >> 6].fetch_and(~(bits << shift), relaxed);
+                if (shift != 0 && (bits >> (64 - shift)))
+                    visited[(pos >> 6) + 1].fetch_and(~(bits >> (64 - shift)), relaxed);
+            }
+        }
+        passable.fetch_add(count, relaxed);
+    });
+
+    return passable.load();
+}
+
+std::size_t ParallelBfs::top_down(const Grid& grid, SearchWorkspace& workspace, ThreadPool& pool, int distance) {
+    auto const n = frontier.size();
+    auto const count = (n + top_down_grain - 1) / top_down_grain;
+    if (chunks.size() < count)
+        chunks.resize(count);
+
+    pool.parallel_for(n, top_down_grain, [&](std::size_t begin, std::size_t end, unsigned) {
+        auto& out = chunks[begin / top_down_grain];
+        out.clear();
+
+        for (auto i = begin; i < end; ++i) {
+            auto const cur = frontier[i];
+            grid.for_each_neighbor(cur, [&](int neighbor) {
+                if (claim(visited.get(), neighbor)) {
+                    workspace.visit(neighbor, distance, cur);
+                    out.push_back(neighbor);
+                }
+            });
+        }
+    });
+
+    return count;
+}
+
+std::size_t ParallelBfs::bottom_up(const Grid& grid, SearchWorkspace& workspace, ThreadPool& pool, int distance) {
+    pool.parallel_for(frontier.size(), top_down_grain, [this](std::size_t begin, std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i)
+            claim(in_frontier.get(), frontier[i]);
+    });
+
+    // Every chunk owns whole words of the visited bitmap, so no other thread writes them.
+    auto const count = (words + bottom_up_grain - 1) / bottom_up_grain;
+    if (chunks.size() < count)
+        chunks.resize(count);
+
+    pool.parallel_for(words, bottom_up_grain, [&](std::size_t begin, std::size_t end, unsigned) {
+        auto& out = chunks[begin / bottom_up_grain];
+        out.clear();
+
+        for (auto k = begin; k < end; ++k) {
+            auto unvisited = ~visited[k].load(relaxed);
+            std::uint64_t found = 0;
+
+            while (unvisited) {
+                auto const bit = count_trailing_zeros(unvisited);
+                unvisited &= unvisited - 1;
+
+                auto const cur = static_cast<int>(k * 64) + bit;
+                auto parent = -1;
+                grid.for_each_neighbor(cur, [&](int neighbor) {
+                    if (parent < 0 && test(in_frontier.get(), neighbor))
+                        parent = neighbor;
+                });
+
+                if (parent >= 0) {
+                    workspace.visit(cur, distance, parent);
+                    out.push_back(cur);
+                    found |= std::uint64_t{1} << bit;
+                }
+            }
+
+            if (found)
+                visited[k].fetch_or(found, relaxed);
+        }
+    });
+
+    // Only words holding frontier cells have bits set.
+    pool.parallel_for(frontier.size(), top_down_grain, [this](std::size_t begin, std::size_t end, unsigned) {
+        for (auto i = begin; i < end; ++i)
+            in_frontier[frontier[i] >> 6].store(0, relaxed);
+    });
+
+    return count;
+}
+
+std::size_t ParallelBfs::run(const Grid& grid, SearchWorkspace& workspace, ThreadPool& pool, int start, int end,
+                             SearchTrace& trace) {
+    auto& stats = trace.stats();
+    auto const passable = prepare(grid, pool);
+
+    claim(visited.get(), start);
+    workspace.visit(start, 0, start);
+    frontier.assign(1, start);
+
+    auto unvisited = passable - 1;
+    auto bottom_up_levels = std::size_t{0};
+    auto is_bottom_up = false;
+    auto previous = std::size_t{0};  // Size of the previous level.
+
+    for (auto distance = 1; !frontier.empty(); ++distance) {
+        // Record the level, the search is done once it holds the end.
+        auto done = false;
+        for (auto const cell : frontier) {
+            trace.add_visited(cell);
+            if (cell == end) {
+                done = true;
+                break;
+            }
+        }
+        if (done)
+            break;
+
+        stats.pops += frontier.size();
+        stats.expanded += frontier.size();
+        stats.peak_frontier = std::max(stats.peak_frontier, frontier.size());
+
+        if (!is_bottom_up && frontier.size() > unvisited / alpha)
+            is_bottom_up = true;
+        else if (is_bottom_up && frontier.size() < previous && frontier.size() < passable / beta)
+            is_bottom_up = false;
+        previous = frontier.size();
+
+        std::size_t count;
+        if (is_bottom_up) {
+            count = bottom_up(grid, workspace, pool, distance);
+            ++bottom_up_levels;
+        } else {
+            count = top_down(grid, workspace, pool, distance);
+        }
+
+        // The cells of the next level in chunk order.
+        next.clear();
+        for (std::size_t c = 0; c < count; ++c)
+            next.insert(next.end(), chunks[c].begin(), chunks[c].end());
+
+        unvisited -= next.size();
+        stats.generated += next.size();
+        stats.pushes += next.size();
+        std::swap(frontier, next);
+    }
+
+    return bottom_up_levels;
+}
@@ -0,0 +1,7 @@
+#include "search_trace.h"
+
+#include <algorithm>
+
+void SearchTrace::reverse_path() {
+    std::reverse(cells.begin() + static_cast<std::ptrdiff_t>(visited_count), cells.end());
+}
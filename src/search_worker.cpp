@@ -0,0 +1,74 @@
+#include "search_worker.h"
+
+#include <utility>
+
+namespace {
+
+/**
+ * Thrown by the sink of a cancelled search to unwind it.
+ */
+struct Cancelled {};
+
+}  // namespace
+
+SearchWorker::~SearchWorker() {
+    cancel();
+}
+
+void SearchWorker::start(Maze& m, Search search) {
+    cancel();
+
+    maze = &m;
+    maze->set_trace_sink([this](int idx, bool backward) {
+        if (cancelled.load(std::memory_order_relaxed))
+            throw Cancelled{};
+
+        auto const cell = static_cast<std::uint32_t>(idx) | (backward ? backward_bit : 0);
+        while (!ring.push(cell)) {
+            if (cancelled.load(std::memory_order_relaxed))
+                throw Cancelled{};
+            std::this_thread::yield();
+        }
+    });
+
+    thread = std::thread([this, search = std::move(search)] {
+        result.clear();
+        try {
+            // The returned trace holds the sink, which is not handed out.
+            auto trace = search(*maze);
+            for (std::size_t i = 0; i < trace.path_size(); ++i)
+                result.add_path(trace.path(i));
+            result.stats() = trace.stats();
+        } catch (const Cancelled&) {
+            result.clear();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        done.store(true, std::memory_order_release);
+    });
+}
+
+void SearchWorker::join() {
+    if (thread.joinable())
+        thread.join();
+    if (maze)
+        maze->set_trace_sink({});
+    maze = nullptr;
+
+    ring.clear();
+    cancelled.store(false, std::memory_order_relaxed);
+    done.store(false, std::memory_order_relaxed);
+}
+
+void SearchWorker::cancel() {
+    cancelled.store(true, std::memory_order_relaxed);
+    join();
+    error = nullptr;
+}
+
+SearchTrace SearchWorker::take() {
+    join();
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+    return std::move(result);
+}
@@ -0,0 +1,26 @@
+#include "search_workspace.h"
+
+#include <algorithm>
+
+void SearchWorkspace::prepare(int cells) {
+    if (size() != cells) {
+        stamp.assign(cells, 0);
+        dist.assign(cells, infinity);
+        parent.assign(cells, -1);
+        heap.prepare(cells);
+        generation = 0;
+    }
+    reset();
+}
+
+void SearchWorkspace::reset() {
+    frontier.clear();
+    heap.clear();
+
+    // Generation 0 is never used, so a freshly sized workspace is entirely unvisited.
+    // On wrap around, the stamps have to be cleared once.
+    if (++generation == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+}
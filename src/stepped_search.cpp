@@ -0,0 +1,157 @@
+#include "stepped_search.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "grid_metrics.h"
+
+namespace {
+
+/// Steps between two checks of the time budget.
+constexpr std::size_t steps_per_check = 64;
+
+}  // namespace
+
+SteppedSearch::SteppedSearch(const Maze& maze, Algorithm algorithm, Heuristics heuristic)
+    : grid{maze.get_grid()},
+      start{maze.get_start().id},
+      end{maze.get_end().id},
+      algorithm{algorithm},
+      heuristic{algorithm == Algorithm::AStar ? heuristic : Heuristics::Dijkstra} {
+    workspace.prepare(grid.size());
+    workspace.visit(start, 0, start);
+
+    // The frontier is the one of the search of the same name on Maze.
+    switch (algorithm) {
+        case Algorithm::Bfs:
+        case Algorithm::Dfs:
+            workspace.frontier.push_back(start);
+            break;
+        case Algorithm::Dijkstra:
+            workspace.heap.push(0, start);
+            break;
+        case Algorithm::AStar:
+            workspace.heap.push(h(start), start);
+            break;
+    }
+}
+
+int SteppedSearch::h(int idx) const {
+    return heuristic_distance(heuristic, grid.x_of(idx) - grid.x_of(end), grid.y_of(idx) - grid.y_of(end));
+}
+
+std::size_t SteppedSearch::frontier_size() const {
+    switch (algorithm) {
+        case Algorithm::Bfs:
+        case Algorithm::Dfs:
+            return workspace.frontier.size() - head;
+        case Algorithm::Dijkstra:
+        case Algorithm::AStar:
+            break;
+    }
+    return workspace.heap.size();
+}
+
+bool SteppedSearch::step_once() {
+    auto& stats = search_stats;
+    if (frontier_size() == 0) {
+        finished = true;
+        return false;
+    }
+    stats.peak_frontier = std::max(stats.peak_frontier, frontier_size());
+
+    // Take the next node. Only Dijkstra skips nodes that were queued with a larger distance.
+    auto queued_cost = 0;
+    switch (algorithm) {
+        case Algorithm::Bfs:
+            cur = workspace.frontier[head++];
+            break;
+        case Algorithm::Dfs:
+            cur = workspace.frontier.back();
+            workspace.frontier.pop_back();
+            break;
+        case Algorithm::Dijkstra:
+            std::tie(queued_cost, cur) = workspace.heap.pop();
+            break;
+        case Algorithm::AStar:
+            cur = workspace.heap.pop().second;
+            break;
+    }
+    ++stats.pops;
+    closed_cells.push_back(cur);
+
+    if (cur == end) {
+        finished = true;
+        return true;
+    }
+    if (algorithm == Algorithm::Dijkstra && workspace.distance(cur) < queued_cost)
+        return true;
+
+    ++stats.expanded;
+    auto const d = (algorithm == Algorithm::Dijkstra ? queued_cost : workspace.distance(cur)) + 1;
+    grid.for_each_neighbor(cur, [&](int n) {
+        auto const reached = workspace.visited(n);
+        switch (algorithm) {
+            case Algorithm::Bfs:
+            case Algorithm::Dfs:
+                if (reached)
+                    return;
+                workspace.visit(n, d, cur);
+                workspace.frontier.push_back(n);
+                break;
+            case Algorithm::Dijkstra:
+            case Algorithm::AStar:
+                if (d >= workspace.distance(n))
+                    return;
+                workspace.visit(n, d, cur);
+                if (algorithm == Algorithm::Dijkstra)
+                    workspace.heap.push(d, n);
+                else
+                    workspace.heap.push(d + h(n), n, -d);
+                break;
+        }
+        if (!reached) {
+            opened_cells.push_back(n);
+            ++stats.generated;
+        }
+        ++stats.pushes;
+    });
+    return true;
+}
+
+std::size_t SteppedSearch::step(std::size_t n, std::chrono::nanoseconds budget) {
+    opened_cells.clear();
+    closed_cells.clear();
+
+    auto const t1 = std::chrono::steady_clock::now();
+    std::size_t steps = 0;
+    while (steps < n && !finished && step_once()) {
+        ++steps;
+        if (budget.count() > 0 && steps % steps_per_check == 0 && std::chrono::steady_clock::now() - t1 >= budget)
+            break;
+    }
+    auto const t2 = std::chrono::steady_clock::now();
+
+    auto& stats = search_stats;
+    stats.wall_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+    if (finished) {
+        stats.path_cost = found() ? workspace.distance(end) : -1;
+        stats.path_length = found() ? static_cast<std::size_t>(stats.path_cost) + 1 : 0;
+    }
+    return steps;
+}
+
+std::vector<int> SteppedSearch::path() const {
+    std::vector<int> res;
+    if (!found())
+        return res;
+
+    // The start is its own predecessor.
+    for (auto c = end; ; c = workspace.parent_of(c)) {
+        res.push_back(c);
+        if (c == workspace.parent_of(c))
+            break;
+    }
+    std::reverse(res.begin(), res.end());
+    return res;
+}
@@ -0,0 +1,67 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    workers.reserve(threads - 1);
+    for (auto i = 1u; i < threads; ++i)
+        workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+
+    for (auto& t : workers)
+        t.join();
+}
+
+void ThreadPool::run(const std::function<void(unsigned worker)>& f) {
+    if (workers.empty()) {
+        f(0);
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        job = &f;
+        running = static_cast<unsigned>(workers.size());
+        ++epoch;
+    }
+    wake.notify_all();
+
+    f(0);
+
+    std::unique_lock lock(mutex);
+    finished.wait(lock, [this] { return running == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::work(unsigned worker) {
+    std::uint64_t seen = 0;
+
+    for (;;) {
+        const std::function<void(unsigned)>* f;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this, seen] { return stop || epoch != seen; });
+            if (stop)
+                return;
+            seen = epoch;
+            f = job;
+        }
+
+        (*f)(worker);
+
+        {
+            std::lock_guard lock(mutex);
+            if (--running != 0)
+                continue;
+        }
+        finished.notify_one();
+    }
+}
@@ -0,0 +1,107 @@
+#include "tiled_grid.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#include "maze_file.h"
+
+TiledGrid::TiledGrid(const std::string& path, std::size_t memory_budget)
+    : capacity{std::max<std::size_t>(1, memory_budget / tile_bytes)} {
+    // Tiles are read in pieces of a row each. A stream buffer would read far more at every seek.
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw std::runtime_error("Failed to open " + path);
+    auto const file_size = static_cast<std::uint64_t>(file.tellg());
+
+    maze_file::Header header{};
+    file.seekg(0);
+    if (file_size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        throw std::runtime_error(path + " is not a maze file");
+    maze_file::check_header(header, file_size, path);
+
+    maze_file::Trailer trailer{};
+    file.seekg(static_cast<std::streamoff>(header.header_size + maze_file::plane_bytes(header)));
+    if (!file.read(reinterpret_cast<char*>(&trailer), sizeof(trailer)))
+        throw std::runtime_error("Failed to read " + path);
+    maze_file::check_trailer(header, trailer, path);
+
+    w = static_cast<std::int64_t>(header.width);
+    h = static_cast<std::int64_t>(header.height);
+    words_per_row = static_cast<std::int64_t>(header.words_per_row);
+    plane_offset = static_cast<std::int64_t>(header.header_size);
+    tiles_per_row = (w + tile_size - 1) / tile_size;
+    start_idx = trailer.start;
+    end_idx = trailer.end;
+}
+
+const TiledGrid::Tile& TiledGrid::tile(std::uint64_t key) {
+    // Searches mostly stay in one tile, which is always the first.
+    if (!lru.empty() && lru.front().key == key) {
+        ++tile_stats.hits;
+        return lru.front();
+    }
+
+    auto const it = resident.find(key);
+    if (it != resident.end()) {
+        ++tile_stats.hits;
+        lru.splice(lru.begin(), lru, it->second);
+        return lru.front();
+    }
+
+    // Reuse the buffer of the least recently used tile if the budget is used up.
+    ++tile_stats.faults;
+    if (lru.size() < capacity) {
+        lru.push_front(Tile{key, std::vector<std::uint64_t>(std::size_t{tile_size} * tile_words)});
+    } else {
+        ++tile_stats.evictions;
+        resident.erase(lru.back().key);
+        lru.splice(lru.begin(), lru, std::prev(lru.end()));
+        lru.front().key = key;
+    }
+
+    // A tile that failed to read is dropped, so its key is not found later with wrong cells.
+    try {
+        read(lru.front());
+    } catch (...) {
+        lru.pop_front();
+        file.clear();
+        throw;
+    }
+    resident[key] = lru.begin();
+    return lru.front();
+}
+
+void TiledGrid::read(Tile& t) {
+    auto const tile_x = static_cast<std::int64_t>(t.key) % tiles_per_row;
+    auto const tile_y = static_cast<std::int64_t>(t.key) / tiles_per_row;
+    auto const first_word = tile_x * tile_words;
+    auto const count = std::min<std::int64_t>(tile_words, words_per_row - first_word);
+    auto const first_row = tile_y * tile_size;
+    auto const rows = std::min<std::int64_t>(tile_size, h - first_row);
+
+    std::fill(t.words.begin(), t.words.end(), 0);
+
+    // The rows of a narrow grid are read at once, one seek per row costs more than the extra bytes.
+    if (words_per_row <= max_band_words) {
+        band.resize(static_cast<std::size_t>(rows * words_per_row));
+        file.seekg(static_cast<std::streamoff>(plane_offset + first_row * words_per_row * 8));
+        if (!file.read(reinterpret_cast<char*>(band.data()), static_cast<std::streamsize>(band.size() * 8)))
+            throw std::runtime_error("Failed to read a tile of the maze file");
+        tile_stats.bytes_read += band.size() * 8;
+
+        for (auto r = 0; r < rows; ++r) {
+            auto const* src = band.data() + r * words_per_row + first_word;
+            std::copy(src, src + count, t.words.data() + r * tile_words);
+        }
+        return;
+    }
+
+    for (auto r = 0; r < rows; ++r) {
+        file.seekg(static_cast<std::streamoff>(plane_offset + ((first_row + r) * words_per_row + first_word) * 8));
+        if (!file.read(reinterpret_cast<char*>(t.words.data() + r * tile_words), static_cast<std::streamsize>(count * 8)))
+            throw std::runtime_error("Failed to read a tile of the maze file");
+        tile_stats.bytes_read += static_cast<std::uint64_t>(count * 8);
+    }
+}
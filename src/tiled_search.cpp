@@ -0,0 +1,270 @@
+#include "tiled_search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "grid_metrics.h"
+
+namespace tiled {
+
+namespace {
+
+/**
+ * Returns the tile cache activity since before.
+ */
+TileStats since(const TileStats& before, const TileStats& now) {
+    return {now.hits - before.hits, now.faults - before.faults, now.evictions - before.evictions,
+            now.bytes_read - before.bytes_read};
+}
+
+/**
+ * Walks the predecessors from the end back to the start, which is its own predecessor.
+ */
+template <typename Parent>
+std::vector<std::uint64_t> reconstruct(std::uint64_t end, Parent&& parent) {
+    std::vector<std::uint64_t> path{end};
+    for (auto cur = end; parent(cur) != cur;) {
+        cur = parent(cur);
+        path.push_back(cur);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+/**
+ * Completes the statistics of a finished search.
+ */
+void finish(Result& res, TiledGrid& grid, const TileStats& before, std::chrono::steady_clock::time_point t1) {
+    auto const t2 = std::chrono::steady_clock::now();
+    res.stats.wall_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+    res.stats.path_length = res.path.size();
+    res.stats.path_cost = res.path.empty() ? -1 : static_cast<int>(res.path.size()) - 1;
+    res.tiles = since(before, grid.stats());
+}
+
+}  // namespace
+
+Result bfs(TiledGrid& grid, std::uint64_t start, std::uint64_t end) {
+    Result res;
+    auto& stats = res.stats;
+    auto const before = grid.stats();
+
+    struct Node {
+        std::int64_t distance;
+        std::uint64_t parent;
+    };
+
+    // A cell reached from another tile, which is only looked at once that tile is resident.
+    struct Pending {
+        std::int64_t distance;
+        std::uint64_t idx;
+        std::uint64_t parent;
+    };
+
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    std::unordered_map<std::uint64_t, Node> nodes;
+    std::unordered_map<std::uint64_t, std::vector<Pending>> pending;  // Per tile.
+    std::size_t waiting = 0;                                          // Number of pending cells.
+
+    // Tiles with pending cells by their smallest pending distance, stale entries are skipped.
+    using TileEntry = std::pair<std::int64_t, std::uint64_t>;
+    std::priority_queue<TileEntry, std::vector<TileEntry>, std::greater<>> tiles;
+
+    auto const wait = [&](std::int64_t distance, std::uint64_t idx, std::uint64_t parent) {
+        auto const tile = grid.tile_of(idx);
+        pending[tile].push_back({distance, idx, parent});
+        tiles.push({distance, tile});
+        ++waiting;
+        ++stats.pushes;
+    };
+
+    auto best = std::numeric_limits<std::int64_t>::max();  // Distance of the end found so far.
+    std::vector<Pending> sources;
+    std::vector<std::pair<std::int64_t, std::uint64_t>> queue;
+    wait(0, start, start);
+
+    while (!tiles.empty()) {
+        auto const [distance, tile] = tiles.top();
+        tiles.pop();
+
+        // Every cell not expanded yet is at least as far away as the end.
+        if (distance >= best)
+            break;
+
+        auto const it = pending.find(tile);
+        if (it == pending.end() || it->second.empty())
+            continue;
+        sources.swap(it->second);
+        it->second.clear();
+        waiting -= sources.size();
+
+        // Expand the cells of this tile in order of distance, merging the cells reached from other
+        // tiles with the cells reached inside the tile. Distances found earlier are corrected if a
+        // shorter path shows up, so the order of the tiles only affects the amount of work.
+        std::sort(sources.begin(), sources.end(),
+                  [](const Pending& a, const Pending& b) { return a.distance < b.distance; });
+        queue.clear();
+        std::size_t head = 0;
+        std::size_t next = 0;
+
+        while (next < sources.size() || head < queue.size()) {
+            stats.peak_frontier = std::max(stats.peak_frontier, waiting + sources.size() - next + queue.size() - head);
+            ++stats.pops;
+
+            std::uint64_t cur{};
+            std::int64_t d{};
+            if (head < queue.size() && (next == sources.size() || queue[head].first <= sources[next].distance)) {
+                std::tie(d, cur) = queue[head++];
+                if (nodes.at(cur).distance < d)
+                    continue;
+            } else {
+                auto const& p = sources[next++];
+                auto const known = nodes.find(p.idx);
+                if ((known != nodes.end() && known->second.distance <= p.distance) ||
+                    !grid.passable(grid.x_of(p.idx), grid.y_of(p.idx)))
+                    continue;
+                stats.generated += known == nodes.end();
+                nodes[p.idx] = Node{p.distance, p.parent};
+                cur = p.idx;
+                d = p.distance;
+            }
+
+            if (cur == end) {
+                best = std::min(best, d);
+                continue;
+            }
+            if (d + 1 >= best)
+                continue;
+
+            // Neighbors in other tiles wait for their tile, so this tile stays the only one needed.
+            ++stats.expanded;
+            auto const x = grid.x_of(cur);
+            auto const y = grid.y_of(cur);
+            for (auto dy = -1; dy <= 1; ++dy) {
+                for (auto dx = -1; dx <= 1; ++dx) {
+                    if ((dx == 0 && dy == 0) || (!diagonal_movement && dx != 0 && dy != 0) ||
+                        !grid.in_bounds(x + dx, y + dy))
+                        continue;
+
+                    auto const n = grid.index(x + dx, y + dy);
+                    if (grid.tile_of(n) != tile) {
+                        wait(d + 1, n, cur);
+                        continue;
+                    }
+                    if (!grid.passable(x + dx, y + dy))
+                        continue;
+
+                    auto const [known, inserted] = nodes.try_emplace(n, Node{d + 1, cur});
+                    if (!inserted) {
+                        if (known->second.distance <= d + 1)
+                            continue;
+                        known->second = Node{d + 1, cur};
+                    }
+                    stats.generated += inserted;
+                    queue.emplace_back(d + 1, n);
+                    ++stats.pushes;
+                }
+            }
+        }
+        sources.clear();
+    }
+
+    if (best != std::numeric_limits<std::int64_t>::max())
+        res.path = reconstruct(end, [&nodes](std::uint64_t idx) { return nodes.at(idx).parent; });
+
+    finish(res, grid, before, t1);
+    return res;
+}
+
+Result a_star(TiledGrid& grid, std::uint64_t start, std::uint64_t end) {
+    Result res;
+    auto& stats = res.stats;
+    auto const before = grid.stats();
+
+    auto const end_x = grid.x_of(end);
+    auto const end_y = grid.y_of(end);
+    auto const h = [&grid, end_x, end_y](std::uint64_t idx) {
+        return grid_distance(grid.x_of(idx) - end_x, grid.y_of(idx) - end_y);
+    };
+
+    struct Entry {
+        std::int64_t f_score;
+        std::int64_t g_score;
+        std::uint64_t tile;
+        std::uint64_t idx;
+
+        // std::priority_queue pops the largest entry, so the best entry compares largest.
+        bool operator<(const Entry& o) const {
+            if (f_score != o.f_score)
+                return f_score > o.f_score;
+            if (g_score != o.g_score)
+                return g_score < o.g_score;
+            return tile > o.tile;
+        }
+    };
+
+    struct Node {
+        std::int64_t g_score;
+        std::uint64_t parent;
+    };
+
+    // Take the first timestamp.
+    auto const t1 = std::chrono::steady_clock::now();
+
+    if (!grid.passable(grid.x_of(start), grid.y_of(start)) || !grid.passable(grid.x_of(end), grid.y_of(end))) {
+        finish(res, grid, before, t1);
+        return res;
+    }
+
+    // Stale queue entries are skipped when their g_score is worse than the known one.
+    std::unordered_map<std::uint64_t, Node> nodes{{start, Node{0, start}}};
+    std::priority_queue<Entry> pq;
+    pq.push({h(start), 0, grid.tile_of(start), start});
+
+    auto found = false;
+    while (!pq.empty()) {
+        stats.peak_frontier = std::max(stats.peak_frontier, pq.size());
+
+        auto const cur = pq.top();
+        pq.pop();
+        ++stats.pops;
+
+        if (cur.idx == end) {
+            found = true;
+            break;
+        }
+        if (cur.g_score > nodes.at(cur.idx).g_score)
+            continue;
+
+        ++stats.expanded;
+        auto const tentative_g_score = cur.g_score + 1;
+        grid.for_each_neighbor(cur.idx, [&](std::uint64_t n) {
+            auto const [it, inserted] = nodes.try_emplace(n, Node{tentative_g_score, cur.idx});
+            if (!inserted) {
+                if (tentative_g_score >= it->second.g_score)
+                    return;
+                it->second = Node{tentative_g_score, cur.idx};
+            }
+
+            stats.generated += inserted;
+            pq.push({tentative_g_score + h(n), tentative_g_score, grid.tile_of(n), n});
+            ++stats.pushes;
+        });
+    }
+
+    if (found)
+        res.path = reconstruct(end, [&nodes](std::uint64_t idx) { return nodes.at(idx).parent; });
+
+    finish(res, grid, before, t1);
+    return res;
+}
+
+}  // namespace tiled
@@ -0,0 +1,354 @@
+#include "wavefront.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MAZE_WAVEFRONT_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * One row of the next level. The frontier rows have a zero word before and after them and the
+ * label is null if the levels are not recorded or the level is 0 modulo 3.
+ */
+struct Step {
+    const std::uint64_t* up;        /// Frontier row above.
+    const std::uint64_t* cur;       /// Frontier row.
+    const std::uint64_t* down;      /// Frontier row below.
+    const std::uint64_t* passable;  /// Row of the grid.
+    std::uint64_t* visited;
+    std::uint64_t* next;
+    std::uint64_t* label;
+    int words;
+};
+
+using Kernel = bool (*)(const Step& s);
+
+/**
+ * Returns the cells of a frontier row and their left and right neighbors, carrying the bits
+ * across the words.
+ */
+inline std::uint64_t spread(const std::uint64_t* row, int i) {
+    return row[i] | row[i] << 1 | row[i - 1] >> 63 | row[i] >> 1 | row[i + 1] << 63;
+}
+
+/**
+ * Computes the words [begin, end) of a row of the next level. Returns true if it has a cell.
+ */
+bool step_words(const Step& s, int begin, int end) {
+    std::uint64_t any = 0;
+    for (auto i = begin; i < end; ++i) {
+        auto reached = spread(s.cur, i);
+        if constexpr (diagonal_movement)
+            reached |= spread(s.up, i) | spread(s.down, i);
+        else
+            reached |= s.up[i] | s.down[i];
+
+        auto const n = reached & s.passable[i] & ~s.visited[i];
+        s.visited[i] |= n;
+        s.next[i] = n;
+        if (s.label)
+            s.label[i] |= n;
+        any |= n;
+    }
+    return any != 0;
+}
+
+bool step_scalar(const Step& s) { return step_words(s, 0, s.words); }
+
+#ifdef MAZE_WAVEFRONT_X86
+
+__attribute__((target("sse2"))) inline __m128i spread_sse2(const std::uint64_t* p) {
+    auto const c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    auto const l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p - 1));
+    auto const r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+    auto const left = _mm_or_si128(_mm_slli_epi64(c, 1), _mm_srli_epi64(l, 63));
+    auto const right = _mm_or_si128(_mm_srli_epi64(c, 1), _mm_slli_epi64(r, 63));
+    return _mm_or_si128(c, _mm_or_si128(left, right));
+}
+
+/**
+ * Computes the words [begin, end) of a row of the next level two at a time, the last one with the
+ * scalar loop if the number is odd. Returns true if it has a cell.
+ */
+__attribute__((target("sse2"))) bool step_words_sse2(const Step& s, int begin, int end) {
+    auto any = _mm_setzero_si128();
+    auto i = begin;
+    for (; i + 2 <= end; i += 2) {
+        auto reached = spread_sse2(s.cur + i);
+        if constexpr (diagonal_movement) {
+            reached = _mm_or_si128(reached, _mm_or_si128(spread_sse2(s.up + i), spread_sse2(s.down + i)));
+        } else {
+            auto const up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.up + i));
+            auto const down = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.down + i));
+            reached = _mm_or_si128(reached, _mm_or_si128(up, down));
+        }
+
+        auto const passable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.passable + i));
+        auto const visited = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.visited + i));
+        auto const n = _mm_andnot_si128(visited, _mm_and_si128(reached, passable));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(s.visited + i), _mm_or_si128(visited, n));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(s.next + i), n);
+        if (s.label) {
+            auto const label = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.label + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s.label + i), _mm_or_si128(label, n));
+        }
+        any = _mm_or_si128(any, n);
+    }
+
+    auto const tail = step_words(s, i, end);
+    return tail || _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xFFFF;
+}
+
+__attribute__((target("sse2"))) bool step_sse2(const Step& s) { return step_words_sse2(s, 0, s.words); }
+
+__attribute__((target("avx2"))) inline __m256i spread_avx2(const std::uint64_t* p) {
+    auto const c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    auto const l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p - 1));
+    auto const r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+    auto const left = _mm256_or_si256(_mm256_slli_epi64(c, 1), _mm256_srli_epi64(l, 63));
+    auto const right = _mm256_or_si256(_mm256_srli_epi64(c, 1), _mm256_slli_epi64(r, 63));
+    return _mm256_or_si256(c, _mm256_or_si256(left, right));
+}
+
+__attribute__((target("avx2"))) bool step_avx2(const Step& s) {
+    auto any = _mm256_setzero_si256();
+    auto i = 0;
+    for (; i + 4 <= s.words; i += 4) {
+        auto reached = spread_avx2(s.cur + i);
+        if constexpr (diagonal_movement) {
+            reached = _mm256_or_si256(reached, _mm256_or_si256(spread_avx2(s.up + i), spread_avx2(s.down + i)));
+        } else {
+            auto const up = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s.up + i));
+            auto const down = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s.down + i));
+            reached = _mm256_or_si256(reached, _mm256_or_si256(up, down));
+        }
+
+        auto const passable = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s.passable + i));
+        auto const visited = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s.visited + i));
+        auto const n = _mm256_andnot_si256(visited, _mm256_and_si256(reached, passable));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s.visited + i), _mm256_or_si256(visited, n));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s.next + i), n);
+        if (s.label) {
+            auto const label = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s.label + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(s.label + i), _mm256_or_si256(label, n));
+        }
+        any = _mm256_or_si256(any, n);
+    }
+
+    // Most rows of a level only have a few words to compute, which are left for the SSE loop.
+    auto const tail = step_words_sse2(s, i, s.words);
+    return tail || !_mm256_testz_si256(any, any);
+}
+
+#endif  // MAZE_WAVEFRONT_X86
+
+Kernel kernel_of(Wavefront::Kernel kernel) {
+    switch (kernel) {
+#ifdef MAZE_WAVEFRONT_X86
+        case Wavefront::Kernel::Sse2:
+            return step_sse2;
+        case Wavefront::Kernel::Avx2:
+            return step_avx2;
+#endif
+        default:
+            return step_scalar;
+    }
+}
+
+int lowest_bit(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    auto bit = 0;
+    for (; (word & 1u) == 0; word >>= 1)
+        ++bit;
+    return bit;
+#endif
+}
+
+int popcount(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    auto count = 0;
+    for (; word != 0; word &= word - 1)
+        ++count;
+    return count;
+#endif
+}
+
+}  // namespace
+
+bool Wavefront::supported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#ifdef MAZE_WAVEFRONT_X86
+        case Kernel::Sse2:
+            return __builtin_cpu_supports("sse2");
+        case Kernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+Wavefront::Kernel Wavefront::best_kernel() {
+    if (supported(Kernel::Avx2))
+        return Kernel::Avx2;
+    if (supported(Kernel::Sse2))
+        return Kernel::Sse2;
+    return Kernel::Scalar;
+}
+
+void Wavefront::set_kernel(Kernel k) {
+    if (!supported(k))
+        throw std::runtime_error("The wavefront kernel is not supported by this CPU");
+    kernel = k;
+}
+
+void Wavefront::prepare(const Grid& grid) {
+    w = grid.width();
+    h = grid.height();
+    stride = grid.words_per_row();
+    pitch = stride + 2;
+    summary_stride = (stride + 63) / 64;
+    summary_pitch = summary_stride + 2;
+
+    auto const words = static_cast<std::size_t>(h + 2) * static_cast<std::size_t>(pitch);
+    for (auto* bits : {&frontier, &next, &visited, &low, &high})
+        bits->assign(words, 0);
+    auto const summary_words = static_cast<std::size_t>(h + 2) * static_cast<std::size_t>(summary_pitch);
+    for (auto* bits : {&summary, &next_summary})
+        bits->assign(summary_words, 0);
+
+    queued.assign(static_cast<std::size_t>(h + 63) / 64, 0);
+    active.clear();
+    levels = 0;
+}
+
+int Wavefront::run(const Grid& grid, int start, int end, std::vector<int>* path) {
+    prepare(grid);
+    if (path)
+        path->clear();
+    if (!grid.passable(start) || !grid.passable(end))
+        return -1;
+
+    auto const step = kernel_of(kernel);
+    auto const start_x = grid.x_of(start);
+    auto const start_y = grid.y_of(start);
+    auto const start_word = start_x >> 6;
+    row(frontier, start_y)[start_word] |= std::uint64_t{1} << (start_x & 63);
+    row(visited, start_y)[start_word] |= std::uint64_t{1} << (start_x & 63);
+    summary_row(summary, start_y)[start_word >> 6] |= std::uint64_t{1} << (start_word & 63);
+    active.push_back(start_y);
+
+    auto distance = 0;
+    while (start != end) {
+        if (active.empty())
+            return -1;
+        ++distance;
+        ++levels;
+
+        // The next level can only have cells in the rows of the frontier and the rows next to them,
+        // which are visited in order to sweep the bitmaps front to back.
+        for (auto const y : active) {
+            for (auto r = std::max(y - 1, 0); r <= std::min(y + 1, h - 1); ++r)
+                queued[static_cast<std::size_t>(r >> 6)] |= std::uint64_t{1} << (r & 63);
+        }
+        rows.clear();
+        for (std::size_t k = 0; k < queued.size(); ++k) {
+            for (auto m = queued[k]; m != 0; m &= m - 1)
+                rows.push_back(static_cast<int>(k * 64) + lowest_bit(m));
+            queued[k] = 0;
+        }
+
+        auto* label = path == nullptr || distance % 3 == 0 ? nullptr : distance % 3 == 1 ? &low : &high;
+        next_active.clear();
+        for (auto const y : rows) {
+            // The words next to a frontier word are found like the cells next to a frontier cell,
+            // and every run of them is computed by one call of the kernel.
+            auto const* above = summary_row(summary, y - 1);
+            auto const* here = summary_row(summary, y);
+            auto const* below = summary_row(summary, y + 1);
+            auto* marks = summary_row(next_summary, y);
+            auto any = false;
+            for (auto k = 0; k < summary_stride; ++k) {
+                auto candidates = spread(above, k) | spread(here, k) | spread(below, k);
+                if (k == summary_stride - 1 && stride % 64 != 0)
+                    candidates &= (std::uint64_t{1} << (stride % 64)) - 1;
+
+                while (candidates != 0) {
+                    auto const lo = lowest_bit(candidates);
+                    auto const rest = ~(candidates >> lo);
+                    auto const count = rest == 0 ? 64 - lo : lowest_bit(rest);
+                    candidates = count + lo == 64 ? 0 : candidates & (~std::uint64_t{0} << (lo + count));
+
+                    auto const first = k * 64 + lo;
+                    Step const s{row(frontier, y - 1) + first, row(frontier, y) + first,
+                                 row(frontier, y + 1) + first, grid.row(y) + first,
+                                 row(visited, y) + first,      row(next, y) + first,
+                                 label ? row(*label, y) + first : nullptr,
+                                 count};
+                    if (!step(s))
+                        continue;
+
+                    any = true;
+                    auto const* n = row(next, y) + first;
+                    for (auto i = 0; i < count; ++i)
+                        marks[k] |= std::uint64_t{n[i] != 0} << (lo + i);
+                }
+            }
+            if (any)
+                next_active.push_back(y);
+        }
+
+        // Words that are not processed stay zero, so only the frontier words have to be cleared.
+        for (auto const y : active) {
+            auto* marks = summary_row(summary, y);
+            auto* cur = row(frontier, y);
+            for (auto k = 0; k < summary_stride; ++k) {
+                for (auto m = marks[k]; m != 0; m &= m - 1)
+                    cur[k * 64 + lowest_bit(m)] = 0;
+                marks[k] = 0;
+            }
+        }
+        std::swap(frontier, next);
+        std::swap(summary, next_summary);
+        std::swap(active, next_active);
+
+        if (bit(frontier, end))
+            break;
+    }
+
+    if (path) {
+        // Every step back goes to a visited neighbor on the level before.
+        path->resize(static_cast<std::size_t>(distance) + 1);
+        auto cur = end;
+        for (auto d = distance; d > 0; --d) {
+            (*path)[static_cast<std::size_t>(d)] = cur;
+            auto const before = (d - 1) % 3;
+            auto found = -1;
+            grid.for_each_neighbor(cur, [&](int n) {
+                if (found < 0 && bit(visited, n) && level_mod3(n) == before)
+                    found = n;
+            });
+            cur = found;
+        }
+        (*path)[0] = cur;
+    }
+    return distance;
+}
+
+std::size_t Wavefront::visited_count() const {
+    std::size_t count = 0;
+    for (auto const word : visited)
+        count += static_cast<std::size_t>(popcount(word));
+    return count;
+}
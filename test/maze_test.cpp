@@ -1,6 +1,19 @@
 #define CATCH_CONFIG_MAIN
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include "maze.h"
+#include "search_worker.h"
+#include "stepped_search.h"
+#include "tiled_search.h"
 
 #include "catch2/catch.hpp"
 
@@ -10,15 +23,7 @@
  * @return An empty 4x4 maze.
  */
 Maze test_maze() {
-    auto maze = Maze(false, 4, 4);
-
-    for (auto &col : maze.maze) {
-        for (auto &n : col) {
-            n.start = false;
-            n.end = false;
-        }
-    }
-    return maze;
+    return Maze(false, 4, 4);
 }
 
 TEST_CASE("Maze with obstacles", "[maze]") {
@@ -30,16 +35,15 @@ TEST_CASE("Maze with obstacles", "[maze]") {
     /////////////
     auto maze = test_maze();
 
-    maze.maze[0][0].start = true;
-    maze.maze[2][0].end = true;
-    maze.start = maze.maze[0][0];
-    maze.maze[1][0].passable = false;
-    maze.maze[3][0].passable = false;
-    maze.maze[1][1].passable = false;
-    maze.maze[2][2].passable = false;
-    maze.maze[0][3].passable = false;
+    maze.set_start(0, 0);
+    maze.set_end(2, 0);
+    maze.set_passable(1, 0, false);
+    maze.set_passable(3, 0, false);
+    maze.set_passable(1, 1, false);
+    maze.set_passable(2, 2, false);
+    maze.set_passable(0, 3, false);
 
-    auto const neighbors = maze.get_neighbors(maze.start);
+    auto const neighbors = maze.get_neighbors(maze.get_start());
 
     REQUIRE(neighbors.size() == 1);
 }
@@ -53,13 +57,47 @@ TEST_CASE("Maze without ostacles", "[maze]") {
     /////////////
     auto maze = test_maze();
 
-    maze.maze[1][1].start = true;
-    maze.maze[2][2].end = true;
-    maze.start = maze.maze[1][1];
+    maze.set_start(1, 1);
+    maze.set_end(2, 2);
 
-    auto const neighbors = maze.get_neighbors(maze.start);
+    auto const neighbors = maze.get_neighbors(maze.get_start());
 
-    REQUIRE(neighbors.size() == 4);
+    REQUIRE(neighbors.size() == max_neighbors);
+}
+
+TEST_CASE("Node views of cells", "[maze]") {
+    /////////////
+    // s o _ _ //
+    // _ _ _ _ //
+    // _ _ _ x //
+    // _ _ _ _ //
+    /////////////
+    auto maze = test_maze();
+
+    maze.set_start(0, 0);
+    maze.set_end(3, 2);
+    maze.set_passable(1, 0, false);
+
+    for (auto y = 0; y < 4; ++y) {
+        for (auto x = 0; x < 4; ++x) {
+            auto const node = maze.get_node(x, y);
+            REQUIRE(node.id == y * 4 + x);
+            REQUIRE(node.x == x);
+            REQUIRE(node.y == y);
+            REQUIRE(node.start == (x == 0 && y == 0));
+            REQUIRE(node.end == (x == 3 && y == 2));
+            REQUIRE(node.passable == !(x == 1 && y == 0));
+            REQUIRE(maze.get_node(node.id).id == node.id);
+        }
+    }
+    REQUIRE(maze.get_start().id == maze.get_node(0, 0).id);
+    REQUIRE(maze.get_end().id == maze.get_node(3, 2).id);
+
+    // Moving the start clears the flag of the old one and makes the new one passable.
+    maze.set_start(1, 0);
+    REQUIRE(!maze.get_node(0, 0).start);
+    REQUIRE(maze.get_node(1, 0).start);
+    REQUIRE(maze.get_node(1, 0).passable);
 }
 
 TEST_CASE("Maze with end next to start", "[maze]") {
@@ -71,19 +109,21 @@ TEST_CASE("Maze with end next to start", "[maze]") {
     /////////////
     auto maze = test_maze();
 
-    maze.maze[0][0].start = true;
-    maze.maze[1][0].end = true;
-    maze.maze[0][1].passable = false;
-    maze.start = maze.maze[0][0];
+    maze.set_start(0, 0);
+    maze.set_end(1, 0);
+    maze.set_passable(0, 1, false);
 
     SECTION("dfs") {
         auto const dfs_res = maze.dfs();
-        REQUIRE(dfs_res.size() == 2);
+        // With diagonal movement the diagonals are pushed last and therefore explored first.
+        if (!diagonal_movement)
+            REQUIRE(dfs_res.visited_size() == 2);
+        REQUIRE(dfs_res.visited(dfs_res.visited_size() - 1) == maze.get_end().id);
     }
 
     SECTION("dfs") {
         auto const bfs_res = maze.bfs();
-        REQUIRE(bfs_res.size() == 2);
+        REQUIRE(bfs_res.visited_size() == 2);
     }
 }
 
@@ -96,19 +136,1099 @@ TEST_CASE("BFS and DFS test", "[maze]") {
     /////////////
     auto maze = test_maze();
 
-    maze.maze[2][1].start = true;
-    maze.maze[2][0].end = true;
-    maze.maze[1][1].passable = false;
-    maze.maze[3][1].passable = false;
-    maze.start = maze.maze[2][1];
+    maze.set_start(2, 1);
+    maze.set_end(2, 0);
+    maze.set_passable(1, 1, false);
+    maze.set_passable(3, 1, false);
 
     SECTION("dfs") {
         auto const dfs_res = maze.dfs();
-        REQUIRE(dfs_res.size() > 3);
+        REQUIRE(dfs_res.visited_size() > 3);
     }
 
     SECTION("dfs") {
         auto const bfs_res = maze.bfs();
-        REQUIRE(bfs_res.size() == 2);
+        REQUIRE(bfs_res.visited_size() == 2);
+    }
+}
+TEST_CASE("Repeated searches on one maze", "[maze]") {
+    /////////////
+    // s _ _ _ //
+    // o o o _ //
+    // _ _ _ _ //
+    // x _ _ _ //
+    /////////////
+    auto maze = test_maze();
+
+    maze.set_start(0, 0);
+    maze.set_end(0, 3);
+    maze.set_passable(0, 1, false);
+    maze.set_passable(1, 1, false);
+    maze.set_passable(2, 1, false);
+
+    auto const first = maze.dijkstra();
+    auto const second = maze.a_star();
+    auto const third = maze.dijkstra();
+
+    auto const expected = diagonal_movement ? 7 : 10;
+    REQUIRE(first.path_size() == expected);
+    REQUIRE(second.path_size() == expected);
+    REQUIRE(third.path_size() == expected);
+    REQUIRE(third.path(0) == maze.get_start().id);
+    REQUIRE(third.path(third.path_size() - 1) == maze.get_end().id);
+}
+
+TEST_CASE("Search trace", "[trace]") {
+    SearchTrace trace;
+    trace.add_visited(3);
+    trace.add_visited(7);
+    trace.add_path(7);
+    trace.add_path(5);
+    trace.add_path(3);
+    trace.reverse_path();
+
+    REQUIRE(trace.visited_size() == 2);
+    REQUIRE(trace.path_size() == 3);
+    REQUIRE(trace.visited(1) == 7);
+    REQUIRE(trace.path(0) == 3);
+    REQUIRE(trace.path(2) == 7);
+
+    auto moved = std::move(trace);
+    REQUIRE(moved.visited_size() == 2);
+    REQUIRE(moved.path(1) == 5);
+}
+
+TEST_CASE("Bucket queue finds the same shortest paths", "[maze]") {
+    // Walls in every odd column with a gap alternating between the bottom and the top row.
+    auto maze = Maze(false, 15, 15);
+    for (auto x = 1; x < 15; x += 2) {
+        for (auto y = 0; y < 15; ++y)
+            maze.set_passable(x, y, false);
+        maze.set_passable(x, x % 4 == 1 ? 14 : 0, true);
+    }
+    maze.set_start(0, 0);
+    maze.set_end(14, 7);
+
+    auto const heap = maze.dijkstra(PriorityQueue::Heap);
+    auto const buckets = maze.dijkstra(PriorityQueue::Buckets);
+    auto const a_star_heap = maze.a_star(Heuristics::Manhattan, PriorityQueue::Heap);
+    auto const a_star_buckets = maze.a_star(Heuristics::Manhattan, PriorityQueue::Buckets);
+
+    REQUIRE(buckets.path_size() == heap.path_size());
+    REQUIRE(buckets.path(buckets.path_size() - 1) == heap.path(heap.path_size() - 1));
+    REQUIRE(a_star_buckets.path_size() == a_star_heap.path_size());
+
+    auto const heuristic = Heuristics::Manhattan;
+
+    // Random mazes, where the queue runs empty between popping the start and pushing its neighbors.
+    for (auto seed = 1u; seed <= 20; ++seed) {
+        auto random = Maze(true, 32, 32, 3, seed);
+        random.set_start(1, 30);
+        random.set_end(30, 1);
+
+        auto const expected = random.dijkstra().stats().path_cost;
+        REQUIRE(random.dijkstra(PriorityQueue::Buckets).stats().path_cost == expected);
+        REQUIRE(random.a_star(heuristic, PriorityQueue::Buckets).stats().path_cost == expected);
+    }
+}
+
+TEST_CASE("Jump Point Search", "[jps]") {
+    /////////////
+    // s _ _ _ //
+    // o o o _ //
+    // _ _ _ _ //
+    // x _ _ _ //
+    /////////////
+    auto maze = test_maze();
+
+    maze.set_start(0, 0);
+    maze.set_end(0, 3);
+    maze.set_passable(0, 1, false);
+    maze.set_passable(1, 1, false);
+    maze.set_passable(2, 1, false);
+
+    auto const expected = maze.dijkstra().path_size();
+
+    SECTION("jps") {
+        auto const res = maze.jps();
+        REQUIRE(res.path_size() == expected);
+        REQUIRE(res.path(0) == maze.get_start().id);
+        REQUIRE(res.path(res.path_size() - 1) == maze.get_end().id);
+    }
+
+    SECTION("jps+ after the maze changed") {
+        REQUIRE(maze.jps_plus().path_size() == expected);
+
+        maze.set_passable(3, 1, false);
+        REQUIRE(maze.jps_plus().path_size() == 0);
+
+        maze.set_passable(1, 1, true);
+        REQUIRE(maze.jps_plus().path_size() == maze.dijkstra().path_size());
+    }
+}
+
+TEST_CASE("Bucket queue visits the same nodes as the heap", "[maze]") {
+    for (auto seed = 1u; seed <= 20; ++seed) {
+        auto maze = Maze(true, 40, 40, 3, seed);
+        maze.set_start(2, 37);
+        maze.set_end(37, 2);
+        if (!maze.bfs().found())
+            continue;
+
+        // Distances from the start, the g_score of every node on a shortest path.
+        DistanceField from_start;
+        from_start.compute(maze.get_grid(), {maze.get_start().id}, false);
+        auto const& grid = maze.get_grid();
+        auto const end_x = grid.x_of(maze.get_end().id);
+        auto const end_y = grid.y_of(maze.get_end().id);
+
+        for (auto const heuristic : {Heuristics::Dijkstra, Heuristics::Manhattan, Heuristics::Euclidean}) {
+            auto const heap = maze.a_star(heuristic, PriorityQueue::Heap);
+            auto const buckets = maze.a_star(heuristic, PriorityQueue::Buckets);
+            REQUIRE(buckets.stats().path_cost == heap.stats().path_cost);
+            REQUIRE(buckets.stats().expanded + 1 == buckets.visited_size());
+
+            // Both visit every node with an f_score below the cost of the path exactly once. Nodes
+            // with an f_score equal to it depend on the order of ties.
+            auto const below_cost = [&](const SearchTrace& trace) {
+                std::vector<int> res;
+                for (std::size_t i = 0; i < trace.visited_size(); ++i) {
+                    auto const idx = trace.visited(i);
+                    auto const f = from_start.distance(idx) +
+                                   heuristic_distance(heuristic, grid.x_of(idx) - end_x, grid.y_of(idx) - end_y);
+                    if (f < heap.stats().path_cost)
+                        res.push_back(idx);
+                }
+                std::sort(res.begin(), res.end());
+                REQUIRE(std::adjacent_find(res.begin(), res.end()) == res.end());
+                return res;
+            };
+            REQUIRE(below_cost(buckets) == below_cost(heap));
+        }
+
+        auto const heap = maze.dijkstra(PriorityQueue::Heap);
+        auto const buckets = maze.dijkstra(PriorityQueue::Buckets);
+        REQUIRE(buckets.stats().path_cost == heap.stats().path_cost);
+        REQUIRE(buckets.stats().expanded + 1 == buckets.visited_size());
+    }
+}
+
+TEST_CASE("Bidirectional search", "[maze]") {
+    // Walls in every odd column with a gap alternating between the bottom and the top row.
+    auto maze = Maze(false, 15, 15);
+    for (auto x = 1; x < 15; x += 2) {
+        for (auto y = 0; y < 15; ++y)
+            maze.set_passable(x, y, false);
+        maze.set_passable(x, x % 4 == 1 ? 14 : 0, true);
+    }
+    maze.set_start(0, 0);
+    maze.set_end(14, 7);
+
+    auto const expected = maze.dijkstra().path_size();
+
+    SECTION("bfs") {
+        auto const res = maze.bidirectional_bfs();
+        REQUIRE(res.path_size() == expected);
+        REQUIRE(res.path(0) == maze.get_start().id);
+        REQUIRE(res.path(res.path_size() - 1) == maze.get_end().id);
+
+        // Both searches expanded cells.
+        std::size_t backward = 0;
+        for (std::size_t i = 0; i < res.visited_size(); ++i)
+            backward += res.visited_backward(i);
+        REQUIRE(backward > 0);
+        REQUIRE(backward < res.visited_size());
+    }
+
+    SECTION("a*") {
+        auto const res = maze.bidirectional_a_star();
+        REQUIRE(res.path_size() == expected);
+        REQUIRE(res.path(0) == maze.get_start().id);
+        REQUIRE(res.path(res.path_size() - 1) == maze.get_end().id);
+    }
+
+    SECTION("unreachable end") {
+        maze.set_passable(13, 14, false);
+        REQUIRE(maze.bidirectional_bfs().path_size() == 0);
+        REQUIRE(maze.bidirectional_a_star().path_size() == 0);
+    }
+
+    SECTION("start is the end") {
+        maze.set_end(0, 0);
+        for (auto const& res : {maze.bidirectional_bfs(), maze.bidirectional_a_star()}) {
+            REQUIRE(res.found());
+            REQUIRE(res.stats().path_cost == 0);
+            REQUIRE(res.path_size() == 1);
+            REQUIRE(res.path(0) == maze.get_start().id);
+        }
+    }
+}
+
+TEST_CASE("A* finds shortest paths with every heuristic", "[maze]") {
+    // With diagonal movement, the heuristics must not overestimate diagonal steps of cost 1.
+    for (auto seed = 1u; seed <= 30; ++seed) {
+        auto maze = Maze(true, 40, 30, 3, seed);
+        maze.set_start(0, 0);
+        maze.set_end(39, 29);
+        auto const expected = maze.bfs().stats().path_cost;
+
+        for (auto const heuristic : {Heuristics::Dijkstra, Heuristics::Manhattan, Heuristics::Euclidean}) {
+            REQUIRE(maze.a_star(heuristic).stats().path_cost == expected);
+
+            SteppedSearch search(maze, SteppedSearch::Algorithm::AStar, heuristic);
+            search.step(std::numeric_limits<std::size_t>::max());
+            REQUIRE(search.stats().path_cost == expected);
+        }
+    }
+}
+
+TEST_CASE("A* expands every cell at most once", "[maze]") {
+    auto maze = Maze(false, 20, 20);
+    maze.set_start(0, 0);
+    maze.set_end(19, 19);
+    for (auto y = 2; y < 20; ++y)
+        maze.set_passable(10, y, false);
+
+    auto const res = maze.a_star(Heuristics::Dijkstra);
+
+    std::vector<bool> seen(20 * 20);
+    for (std::size_t i = 0; i < res.visited_size(); ++i) {
+        REQUIRE_FALSE(seen[res.visited(i)]);
+        seen[res.visited(i)] = true;
+    }
+    REQUIRE(res.path(res.path_size() - 1) == maze.get_end().id);
+}
+
+TEST_CASE("Indexed heap", "[heap]") {
+    IndexedHeap heap;
+    heap.prepare(10);
+
+    heap.push(5, 1);
+    heap.push(3, 2);
+    heap.push(7, 3);
+    heap.push(3, 4, -1);
+    heap.push(1, 3);  // Decrease key.
+    heap.push(9, 2);  // Never raises the priority.
+
+    REQUIRE(heap.size() == 4);
+    REQUIRE(heap.pop() == std::pair(1, 3));
+    REQUIRE(heap.pop() == std::pair(3, 4));
+    REQUIRE(heap.pop() == std::pair(3, 2));
+    REQUIRE(heap.pop() == std::pair(5, 1));
+    REQUIRE(heap.empty());
+    REQUIRE_FALSE(heap.contains(1));
+}
+
+TEST_CASE("Search statistics", "[stats]") {
+    auto maze = Maze(false, 10, 10);
+    maze.set_start(0, 0);
+    maze.set_end(9, 9);
+
+    auto calls = 0;
+    std::string name;
+    maze.set_observer([&](const char* algorithm, const SearchStats& stats) {
+        ++calls;
+        name = algorithm;
+        // Unreachable ends are rejected before the first expansion.
+        REQUIRE((stats.expanded > 0) == (stats.path_cost >= 0));
+    });
+
+    auto const res = maze.dijkstra();
+    auto const& stats = res.stats();
+
+    REQUIRE(calls == 1);
+    REQUIRE(name == "Dijkstra");
+    REQUIRE(stats.path_length == res.path_size());
+    REQUIRE(stats.path_cost == static_cast<int>(res.path_size()) - 1);
+    REQUIRE(stats.expanded <= stats.pops);
+    REQUIRE(stats.pops <= stats.pushes + 1);
+    REQUIRE(stats.peak_frontier > 0);
+
+    maze.set_passable(9, 8, false);
+    maze.set_passable(8, 9, false);
+#ifdef MAZE_DIAGONAL_MOVEMENT
+    maze.set_passable(8, 8, false);
+#endif
+    REQUIRE(maze.bfs().stats().path_cost == -1);
+    REQUIRE(calls == 2);
+}
+
+TEST_CASE("Parallel BFS", "[parallel]") {
+    SECTION("Same distances as BFS") {
+        for (auto seed = 1u; seed <= 10; ++seed) {
+            auto maze = Maze(true, 100, 80, 3, seed);
+            maze.set_start(0, 0);
+            maze.set_end(99, 79);
+
+            auto const bfs = maze.bfs();
+            auto const parallel = maze.parallel_bfs(4);
+
+            REQUIRE(parallel.stats().path_cost == bfs.stats().path_cost);
+            if (!parallel.found()) {
+                REQUIRE(parallel.visited_size() == 0);
+                continue;
+            }
+            REQUIRE(parallel.visited(0) == maze.get_start().id);
+            if (parallel.path_size() != 0) {
+                REQUIRE(parallel.path_size() == static_cast<std::size_t>(bfs.stats().path_cost) + 1);
+                REQUIRE(parallel.visited(parallel.visited_size() - 1) == maze.get_end().id);
+            }
+        }
+    }
+
+    SECTION("Top-down and bottom-up levels") {
+        auto const grid = Grid(200, 150);
+        ThreadPool pool(4);
+        SearchWorkspace workspace;
+        workspace.prepare(grid.size());
+        SearchTrace trace;
+
+        ParallelBfs bfs;
+        REQUIRE(bfs.run(grid, workspace, pool, grid.index(3, 5), -1, trace) > 0);
+
+        // Every cell is visited once, level by level, with its distance on an empty grid.
+        REQUIRE(trace.visited_size() == static_cast<std::size_t>(grid.size()));
+        auto last = 0;
+        for (std::size_t i = 0; i < trace.visited_size(); ++i) {
+            auto const cell = static_cast<int>(trace.visited(i));
+            auto const dx = std::abs(grid.x_of(cell) - 3);
+            auto const dy = std::abs(grid.y_of(cell) - 5);
+            auto const distance = diagonal_movement ? std::max(dx, dy) : dx + dy;
+
+            REQUIRE(workspace.distance(cell) == distance);
+            REQUIRE(distance >= last);
+            last = distance;
+        }
+    }
+}
+
+TEST_CASE("Batch queries", "[parallel]") {
+    auto maze = Maze(true, 60, 40, 3, 7u);
+
+    std::vector<Query> queries;
+    for (auto i = 0; i < 100; ++i)
+        queries.push_back({(i * 37) % (60 * 40), (i * 101 + 13) % (60 * 40)});
+    queries.push_back({-1, 0});
+
+    auto const batch = maze.batch_a_star(queries, 4);
+    REQUIRE(batch.size() == queries.size());
+    REQUIRE(batch.path_size(queries.size() - 1) == 0);
+
+    for (std::size_t i = 0; i + 1 < queries.size(); ++i) {
+        auto const [start, end] = queries[i];
+        if (!maze.get_node(start).passable || !maze.get_node(end).passable) {
+            REQUIRE(batch.cost(i) == -1);
+            continue;
+        }
+
+        maze.set_start(maze.get_node(start).x, maze.get_node(start).y);
+        maze.set_end(maze.get_node(end).x, maze.get_node(end).y);
+        REQUIRE(batch.cost(i) == maze.dijkstra().stats().path_cost);
+
+        // Every path runs from the start to the end over neighboring cells.
+        if (batch.path_size(i) == 0)
+            continue;
+        REQUIRE(batch.path(i, 0) == start);
+        REQUIRE(batch.path(i, batch.path_size(i) - 1) == end);
+        for (std::size_t j = 1; j < batch.path_size(i); ++j) {
+            auto const neighbors = maze.get_grid().neighbors(batch.path(i, j - 1));
+            REQUIRE(std::find(neighbors.begin(), neighbors.end(), batch.path(i, j)) != neighbors.end());
+        }
+    }
+}
+
+TEST_CASE("Hierarchical path-finding", "[hpa]") {
+    SECTION("Finds a path whenever one exists") {
+        for (auto seed = 1u; seed <= 10; ++seed) {
+            auto maze = Maze(true, 70, 50, 3, seed);
+            maze.set_start(2, 3);
+            maze.set_end(65, 47);
+
+            auto const optimal = maze.dijkstra().stats().path_cost;
+            auto const res = maze.hpa_star();
+            auto const cost = res.stats().path_cost;
+
+            REQUIRE((cost < 0) == (optimal < 0));
+            if (cost < 0)
+                continue;
+
+            REQUIRE(cost >= optimal);
+            REQUIRE(res.path_size() == static_cast<std::size_t>(cost) + 1);
+            REQUIRE(res.path(0) == maze.get_start().id);
+            REQUIRE(res.path(res.path_size() - 1) == maze.get_end().id);
+            for (std::size_t j = 1; j < res.path_size(); ++j) {
+                auto const neighbors = maze.get_grid().neighbors(res.path(j - 1));
+                REQUIRE(std::find(neighbors.begin(), neighbors.end(), res.path(j)) != neighbors.end());
+            }
+        }
+    }
+
+    SECTION("Incremental rebuild matches a full build") {
+        auto const toggle = [](Maze& m) {
+            // A wall along a cluster border and a cell in the middle of a cluster.
+            for (auto y = 0; y < 40; ++y)
+                m.set_passable(hpa::cluster_size - 1, y, false);
+            m.set_passable(hpa::cluster_size * 2 + 5, 7, false);
+            m.set_passable(hpa::cluster_size - 1, 12, true);
+        };
+
+        auto incremental = Maze(true, 64, 48, 5, 3u);
+        auto full = Maze(true, 64, 48, 5, 3u);
+        for (auto* m : {&incremental, &full}) {
+            m->set_start(0, 0);
+            m->set_end(63, 47);
+        }
+
+        incremental.hpa_star();
+        toggle(incremental);
+        toggle(full);
+
+        auto const a = incremental.hpa_star();
+        auto const b = full.hpa_star();
+        REQUIRE(a.stats().path_cost == b.stats().path_cost);
+        REQUIRE(a.path_size() == b.path_size());
+        for (std::size_t j = 0; j < a.path_size(); ++j)
+            REQUIRE(a.path(j) == b.path(j));
+    }
+}
+
+TEST_CASE("Indexed heap update and remove", "[heap]") {
+    IndexedHeap heap;
+    heap.prepare(10);
+
+    for (auto i = 0; i < 8; ++i)
+        heap.push(i, i, -i);
+    heap.update(10, 0);     // Raise the priority.
+    heap.update(-1, 7, 3);  // Lower the priority.
+    heap.remove(3);
+    heap.remove(3);
+
+    REQUIRE(heap.size() == 7);
+    REQUIRE(heap.top_tie() == 3);
+    REQUIRE(heap.pop() == std::pair(-1, 7));
+    REQUIRE(heap.pop() == std::pair(1, 1));
+    REQUIRE(heap.pop() == std::pair(2, 2));
+    REQUIRE(heap.pop() == std::pair(4, 4));
+    REQUIRE(heap.pop() == std::pair(5, 5));
+    REQUIRE(heap.pop() == std::pair(6, 6));
+    REQUIRE(heap.pop() == std::pair(10, 0));
+    REQUIRE(heap.empty());
+}
+
+TEST_CASE("D* Lite replanning", "[dstar]") {
+    auto maze = Maze(true, 40, 30, 7, 11u);
+    maze.set_start(1, 1);
+    maze.set_end(38, 28);
+
+    auto const first = maze.d_star_lite();
+    REQUIRE(first.stats().path_cost == maze.dijkstra().stats().path_cost);
+
+    // Block a cell of the path, then open it again, and move the start.
+    REQUIRE(first.path_size() > 2);
+    auto const blocked = maze.get_node(first.path(first.path_size() / 2));
+    maze.set_passable(blocked.x, blocked.y, false);
+    auto const detour = maze.d_star_lite();
+    REQUIRE(detour.stats().path_cost == maze.dijkstra().stats().path_cost);
+    REQUIRE(detour.stats().expanded < first.stats().expanded);
+    for (std::size_t i = 0; i < detour.path_size(); ++i)
+        REQUIRE(detour.path(i) != blocked.id);
+
+    maze.set_passable(blocked.x, blocked.y, true);
+    REQUIRE(maze.d_star_lite().stats().path_cost == first.stats().path_cost);
+
+    maze.set_start(5, 20);
+    auto const moved = maze.d_star_lite();
+    REQUIRE(moved.stats().path_cost == maze.dijkstra().stats().path_cost);
+    if (moved.path_size() != 0)
+        REQUIRE(moved.path(0) == maze.get_start().id);
+
+    // Walls around the end.
+    maze.set_passable(37, 28, false);
+    maze.set_passable(38, 27, false);
+    maze.set_passable(37, 27, false);
+    maze.set_passable(39, 27, false);
+    maze.set_passable(39, 28, false);
+    maze.set_passable(39, 29, false);
+    maze.set_passable(38, 29, false);
+    maze.set_passable(37, 29, false);
+    auto const walled = maze.d_star_lite();
+    REQUIRE(walled.stats().path_cost == -1);
+    REQUIRE(walled.path_size() == 0);
+}
+
+TEST_CASE("Component index", "[components]") {
+    SECTION("Unreachable ends are rejected without a search") {
+        auto maze = Maze(false, 12, 8);
+        maze.set_start(0, 0);
+        maze.set_end(11, 7);
+
+        // A wall from top to bottom.
+        for (auto y = 0; y < 8; ++y)
+            maze.set_passable(5, y, false);
+
+        for (auto const& trace : {maze.bfs(), maze.dfs(), maze.dijkstra(), maze.a_star(Heuristics::Manhattan),
+                                  maze.jps(), maze.jps_plus(), maze.bidirectional_bfs(),
+                                  maze.bidirectional_a_star(), maze.hpa_star(), maze.d_star_lite()}) {
+            REQUIRE(!trace.found());
+            REQUIRE(trace.visited_size() == 0);
+            REQUIRE(trace.path_size() == 0);
+        }
+
+        auto const batch = maze.batch_a_star({{0, 95}, {0, 4}});
+        REQUIRE(batch.cost(0) == -1);
+        REQUIRE(batch.cost(1) == 4);
+
+        // A gap in the wall connects both sides again.
+        maze.set_passable(5, 3, true);
+        auto const trace = maze.a_star(Heuristics::Manhattan);
+        REQUIRE(trace.found());
+        REQUIRE(trace.path(trace.path_size() - 1) == maze.get_end().id);
+    }
+
+    SECTION("Incremental updates match a flood fill") {
+        auto grid = Grid(24, 18);
+        ComponentIndex components;
+        std::srand(5);
+
+        // Labels every passable cell with the smallest index of its component.
+        auto const flood = [&grid]() {
+            std::vector<int> label(grid.size(), -1);
+            std::vector<int> stack;
+            for (auto idx = 0; idx < grid.size(); ++idx) {
+                if (!grid.passable(idx) || label[idx] >= 0)
+                    continue;
+                label[idx] = idx;
+                stack.push_back(idx);
+                while (!stack.empty()) {
+                    auto const cur = stack.back();
+                    stack.pop_back();
+                    grid.for_each_neighbor(cur, [&](int n) {
+                        if (label[n] < 0) {
+                            label[n] = idx;
+                            stack.push_back(n);
+                        }
+                    });
+                }
+            }
+            return label;
+        };
+
+        for (auto step = 0; step < 400; ++step) {
+            auto const idx = std::rand() % grid.size();
+            auto const passable = std::rand() % 3 == 0;
+            if (grid.passable(idx) != passable) {
+                grid.set_passable(grid.x_of(idx), grid.y_of(idx), passable);
+                if (passable)
+                    components.open(grid, idx);
+                else
+                    components.close(grid, idx);
+            }
+
+            auto const label = flood();
+            for (auto i = 0; i < 20; ++i) {
+                auto const a = std::rand() % grid.size();
+                auto const b = std::rand() % grid.size();
+                REQUIRE(components.connected(grid, a, b) == (label[a] >= 0 && label[a] == label[b]));
+            }
+        }
+    }
+}
+
+TEST_CASE("Maze generators", "[generators]") {
+    // Checks that the rooms form a spanning tree: every room is open, the cells between four rooms
+    // are walls, there is one passage less than rooms and every room is reachable.
+    auto const perfect = [](const Grid& grid) {
+        auto rooms = 0;
+        auto passages = 0;
+        for (auto y = 0; y < grid.height(); ++y) {
+            for (auto x = 0; x < grid.width(); ++x) {
+                auto const room = x % 2 == 0 && y % 2 == 0;
+                if (room)
+                    ++rooms;
+                if (room && !grid.passable(x, y))
+                    return false;
+                if (x % 2 == 1 && y % 2 == 1 && grid.passable(x, y))
+                    return false;
+                passages += !room && grid.passable(x, y);
+            }
+        }
+
+        ComponentIndex components;
+        for (auto y = 0; y < grid.height(); y += 2) {
+            for (auto x = 0; x < grid.width(); x += 2) {
+                if (!components.connected(grid, 0, grid.index(x, y)))
+                    return false;
+            }
+        }
+        return passages == rooms - 1;
+    };
+
+    SECTION("Every generator makes a perfect maze") {
+        for (auto const algorithm : {generators::Algorithm::RecursiveBacktracker, generators::Algorithm::Kruskal,
+                                     generators::Algorithm::Prim, generators::Algorithm::Wilson,
+                                     generators::Algorithm::Eller}) {
+            for (auto const& [width, height] : {std::pair(1, 1), std::pair(2, 9), std::pair(31, 17), std::pair(70, 40)}) {
+                for (auto seed = 1u; seed <= 3; ++seed) {
+                    auto grid = Grid(width, height);
+                    generators::generate(algorithm, grid, seed);
+                    REQUIRE(perfect(grid));
+                }
+            }
+
+            auto maze = Maze::generate(algorithm, 41, 30, 9u);
+            REQUIRE(maze.bfs().found());
+        }
+    }
+
+    SECTION("Eller's algorithm streams the same rows") {
+        auto grid = Grid(131, 57);
+        generators::eller(grid, 4u);
+
+        generators::EllerStream stream(131, 57, 4u);
+        for (auto y = 0; y < grid.height(); ++y) {
+            REQUIRE(!stream.done());
+            auto const* row = stream.next();
+            REQUIRE(std::equal(row, row + grid.words_per_row(), grid.row(y)));
+        }
+        REQUIRE(stream.done());
+    }
+}
+
+TEST_CASE("Maze files", "[file]") {
+    auto const path = std::string("maze_test_file.bin");
+
+    SECTION("Saved mazes load with the same cells") {
+        auto maze = Maze(true, 131, 47, 3, 21u);
+        maze.set_start(2, 3);
+        maze.set_end(120, 40);
+        maze.save(path);
+
+        auto loaded = Maze::load(path);
+        REQUIRE(loaded.width() == 131);
+        REQUIRE(loaded.height() == 47);
+        REQUIRE(loaded.get_start().id == maze.get_start().id);
+        REQUIRE(loaded.get_end().id == maze.get_end().id);
+        for (auto y = 0; y < 47; ++y)
+            REQUIRE(std::equal(loaded.get_grid().row(y), loaded.get_grid().row(y) + 3, maze.get_grid().row(y)));
+
+        REQUIRE(loaded.a_star(Heuristics::Manhattan).stats().path_cost ==
+                maze.a_star(Heuristics::Manhattan).stats().path_cost);
+
+        // Changes stay in memory.
+        loaded.set_passable(60, 20, !loaded.is_passable(60, 20));
+        REQUIRE(Maze::load(path).is_passable(60, 20) == maze.is_passable(60, 20));
+    }
+
+    SECTION("Streamed rows") {
+        {
+            generators::EllerStream stream(200, 99, 5u);
+            maze_file::Writer writer(path, 200, 99);
+            while (!stream.done())
+                writer.write_row(stream.next());
+            writer.finish(0, 98 * 200 + 198);
+        }
+
+        auto grid = Grid(200, 99);
+        generators::eller(grid, 5u);
+        auto const loaded = maze_file::load(path);
+        for (auto y = 0; y < 99; ++y)
+            REQUIRE(std::equal(grid.row(y), grid.row(y) + grid.words_per_row(), loaded.grid.row(y)));
+    }
+
+    SECTION("Invalid files are rejected") {
+        std::ofstream(path, std::ios::binary) << "MAZEGRID but nothing else";
+        REQUIRE_THROWS(Maze::load(path));
+        REQUIRE_THROWS(Maze::load("does_not_exist.bin"));
+
+        // A cell past the width of the last row.
+        Maze(true, 131, 47, 3, 21u).save(path);
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            auto const last_word = static_cast<std::streamoff>(sizeof(maze_file::Header) + (47 * 3 - 1) * 8);
+            std::uint64_t word{};
+            file.seekg(last_word);
+            file.read(reinterpret_cast<char*>(&word), sizeof(word));
+            word |= std::uint64_t{1} << 63;
+            file.seekp(last_word);
+            file.write(reinterpret_cast<const char*>(&word), sizeof(word));
+        }
+        REQUIRE_THROWS(Maze::load(path));
+    }
+
+    SECTION("Rejected writes keep the file") {
+        std::ofstream(path, std::ios::binary) << "kept";
+        REQUIRE_THROWS(maze_file::Writer(path, -1, 5));
+
+        std::string contents;
+        std::ifstream(path, std::ios::binary) >> contents;
+        REQUIRE(contents == "kept");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Tiled grid", "[tiled]") {
+    auto const path = std::string("maze_test_tiled.bin");
+    auto maze = Maze(true, 700, 520, 4, 13u);
+    maze.set_start(3, 2);
+    maze.set_end(690, 515);
+    maze.save(path);
+
+    SECTION("Same cells as the grid") {
+        // Two tiles of budget for a grid of 3 x 3 tiles.
+        TiledGrid tiled(path, 2 * TiledGrid::tile_bytes);
+        REQUIRE(tiled.start() == static_cast<std::uint64_t>(maze.get_start().id));
+        REQUIRE(tiled.end() == static_cast<std::uint64_t>(maze.get_end().id));
+
+        for (auto y = 0; y < 520; y += 7) {
+            for (auto x = 0; x < 700; ++x)
+                REQUIRE(tiled.passable(x, y) == maze.is_passable(x, y));
+        }
+        REQUIRE(tiled.resident_tiles() == 2);
+        REQUIRE(tiled.stats().evictions > 0);
+    }
+
+    SECTION("Wide grids read tiles row by row") {
+        auto wide = Maze(true, 4500, 300, 4, 14u);
+        wide.save(path);
+
+        TiledGrid tiled(path, TiledGrid::tile_bytes);
+        for (auto y = 0; y < 300; y += 3) {
+            for (auto x = 0; x < 4500; x += 5)
+                REQUIRE(tiled.passable(x, y) == wide.is_passable(x, y));
+        }
+    }
+
+    SECTION("Tiles that failed to read are read again") {
+        // The first tile evicts the only resident one.
+        TiledGrid tiled(path, TiledGrid::tile_bytes);
+        REQUIRE(tiled.passable(0, 0) == maze.is_passable(0, 0));
+
+        std::ofstream(path, std::ios::binary | std::ios::trunc);
+        REQUIRE_THROWS(tiled.passable(300, 0));
+        REQUIRE_THROWS(tiled.passable(300, 0));
+        REQUIRE(tiled.resident_tiles() == 0);
+    }
+
+    SECTION("Same shortest paths as on the grid") {
+        auto const expected = maze.dijkstra().stats().path_cost;
+
+        TiledGrid tiled(path, 4 * TiledGrid::tile_bytes);
+        auto const bfs = tiled::bfs(tiled, tiled.start(), tiled.end());
+        auto const a_star = tiled::a_star(tiled, tiled.start(), tiled.end());
+
+        REQUIRE(bfs.stats.path_cost == expected);
+        REQUIRE(a_star.stats.path_cost == expected);
+        REQUIRE(bfs.path.size() == a_star.path.size());
+        REQUIRE(bfs.tiles.faults > 0);
+        REQUIRE(tiled.resident_tiles() <= 4);
+
+        if (expected >= 0) {
+            REQUIRE(a_star.path.front() == tiled.start());
+            REQUIRE(a_star.path.back() == tiled.end());
+            for (std::size_t i = 1; i < a_star.path.size(); ++i) {
+                auto const dx = std::abs(tiled.x_of(a_star.path[i]) - tiled.x_of(a_star.path[i - 1]));
+                auto const dy = std::abs(tiled.y_of(a_star.path[i]) - tiled.y_of(a_star.path[i - 1]));
+                REQUIRE(std::max(dx, dy) == 1);
+                REQUIRE(tiled.passable(tiled.x_of(a_star.path[i]), tiled.y_of(a_star.path[i])));
+            }
+        }
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Wavefront BFS", "[wavefront]") {
+    SECTION("Same distances as BFS with every kernel") {
+        for (auto const kernel : {Wavefront::Kernel::Scalar, Wavefront::Kernel::Sse2, Wavefront::Kernel::Avx2}) {
+            if (!Wavefront::supported(kernel))
+                continue;
+
+            // Widths of 3 and 5 words leave a tail after the SIMD loops.
+            for (auto seed = 1u; seed <= 6; ++seed) {
+                auto const width = seed % 2 ? 150 : 300;
+                auto maze = Maze(true, width, 90, 3, seed);
+                maze.set_start(0, 0);
+                maze.set_end(width - 1, 89);
+                auto const bfs = maze.bfs();
+
+                Wavefront wavefront;
+                wavefront.set_kernel(kernel);
+                std::vector<int> path;
+                auto const& grid = maze.get_grid();
+                auto const distance = wavefront.run(grid, maze.get_start().id, maze.get_end().id, &path);
+
+                REQUIRE(distance == bfs.stats().path_cost);
+                REQUIRE(wavefront.run(grid, maze.get_start().id, maze.get_end().id) == distance);
+                if (distance < 0) {
+                    REQUIRE(path.empty());
+                    continue;
+                }
+
+                REQUIRE(path.size() == static_cast<std::size_t>(distance) + 1);
+                REQUIRE(path.front() == maze.get_start().id);
+                REQUIRE(path.back() == maze.get_end().id);
+                for (std::size_t i = 1; i < path.size(); ++i) {
+                    auto const dx = std::abs(grid.x_of(path[i]) - grid.x_of(path[i - 1]));
+                    auto const dy = std::abs(grid.y_of(path[i]) - grid.y_of(path[i - 1]));
+                    REQUIRE((diagonal_movement ? std::max(dx, dy) : dx + dy) == 1);
+                    REQUIRE(grid.passable(path[i]));
+                }
+            }
+        }
+    }
+
+    SECTION("Open grid") {
+        auto const grid = Grid(200, 150);
+        Wavefront wavefront;
+        auto const start = grid.index(130, 5);
+        auto const end = grid.index(3, 140);
+        auto const distance = diagonal_movement ? 135 : 127 + 135;
+
+        REQUIRE(wavefront.run(grid, start, end) == distance);
+        REQUIRE(wavefront.level_count() == static_cast<std::size_t>(distance));
+
+        // The farthest cell is on the last level, so every cell is visited.
+        REQUIRE(wavefront.run(grid, start, grid.index(0, 149)) == (diagonal_movement ? 144 : 130 + 144));
+        REQUIRE(wavefront.visited_count() == static_cast<std::size_t>(grid.size()));
+    }
+
+    SECTION("Maze search") {
+        auto maze = Maze(true, 120, 80, 3, 5u);
+        maze.set_start(0, 0);
+        maze.set_end(119, 79);
+
+        auto const bfs = maze.bfs();
+        auto const wavefront = maze.wavefront_bfs();
+        REQUIRE(wavefront.stats().path_cost == bfs.stats().path_cost);
+        REQUIRE(wavefront.visited_size() == 0);
+        REQUIRE(wavefront.path_size() == static_cast<std::size_t>(bfs.stats().path_cost + 1));
+    }
+}
+
+TEST_CASE("Distance field", "[field]") {
+    auto maze = Maze(true, 80, 60, 3, 21u);
+    maze.set_end(40, 30);
+    auto const& grid = maze.get_grid();
+
+    SECTION("Same distances as BFS") {
+        auto const& field = maze.distance_field();
+        REQUIRE(field.has_directions());
+        REQUIRE(field.distance(maze.get_end().id) == 0);
+
+        for (auto idx = 0; idx < grid.size(); idx += 37) {
+            if (!grid.passable(idx))
+                continue;
+            maze.set_start(grid.x_of(idx), grid.y_of(idx));
+            REQUIRE(field.distance(idx) == maze.bfs().stats().path_cost);
+        }
+    }
+
+    SECTION("Agents follow the field") {
+        for (auto const with_directions : {true, false}) {
+            auto const& field = maze.distance_field(with_directions);
+            REQUIRE(field.has_directions() == with_directions);
+
+            for (auto idx = 0; idx < grid.size(); idx += 13) {
+                auto const path = field.path(grid, idx);
+                if (field.distance(idx) == DistanceField::unreachable) {
+                    REQUIRE(path.empty());
+                    continue;
+                }
+
+                REQUIRE(path.size() == static_cast<std::size_t>(field.distance(idx)) + 1);
+                REQUIRE(path.back() == maze.get_end().id);
+                for (std::size_t i = 1; i < path.size(); ++i) {
+                    auto const neighbors = grid.neighbors(path[i - 1]);
+                    REQUIRE(std::find(neighbors.begin(), neighbors.end(), path[i]) != neighbors.end());
+                }
+            }
+        }
+    }
+
+    SECTION("Nearest of several goals") {
+        std::vector<int> goals{grid.index(0, 0), grid.index(79, 59), grid.index(40, 30), grid.index(5, 50)};
+        DistanceField single;
+        std::vector<int> nearest(static_cast<std::size_t>(grid.size()), DistanceField::unreachable);
+        for (auto const goal : goals) {
+            single.compute(grid, {goal}, false);
+            for (auto idx = 0; idx < grid.size(); ++idx) {
+                auto const d = single.distance(idx);
+                auto& n = nearest[static_cast<std::size_t>(idx)];
+                if (d != DistanceField::unreachable && (n == DistanceField::unreachable || d < n))
+                    n = d;
+            }
+        }
+
+        auto const& field = maze.distance_field(goals);
+        REQUIRE(field.data() == nearest);
+        REQUIRE(field.max_distance() == *std::max_element(nearest.begin(), nearest.end()));
+        REQUIRE(field.reached() == static_cast<std::size_t>(std::count_if(nearest.begin(), nearest.end(), [](int d) {
+                    return d != DistanceField::unreachable;
+                })));
+    }
+}
+
+TEST_CASE("Search worker", "[worker]") {
+    SECTION("Ring buffer keeps the order across threads") {
+        SpscRing<int> ring(100);
+        REQUIRE(ring.capacity() == 128);
+
+        auto const count = 200000;
+        std::thread producer([&ring] {
+            for (auto i = 0; i < count; ++i) {
+                while (!ring.push(i))
+                    std::this_thread::yield();
+            }
+        });
+
+        std::vector<int> received;
+        int item;
+        while (received.size() < static_cast<std::size_t>(count)) {
+            if (ring.pop(item))
+                received.push_back(item);
+            ring.pop_all([&received](int i) { received.push_back(i); });
+        }
+        producer.join();
+
+        REQUIRE(!ring.pop(item));
+        for (auto i = 0; i < count; ++i)
+            REQUIRE(received[static_cast<std::size_t>(i)] == i);
+    }
+
+    SECTION("Streams the same cells as a search on the calling thread") {
+        auto maze = Maze(true, 120, 90, 3, 5u);
+        maze.set_start(0, 0);
+        maze.set_end(119, 89);
+        auto const expected = maze.bidirectional_a_star();
+
+        SearchWorker worker;
+        worker.start(maze, [](Maze& m) { return m.bidirectional_a_star(); });
+        std::vector<std::pair<int, bool>> cells;
+        auto finished = false;
+        while (!finished) {
+            finished = worker.finished();
+            worker.drain([&cells](int idx, bool backward) { cells.emplace_back(idx, backward); });
+        }
+        auto const result = worker.take();
+        REQUIRE(!worker.busy());
+
+        REQUIRE(cells.size() == expected.visited_size());
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            REQUIRE(cells[i].first == expected.visited(i));
+            REQUIRE(cells[i].second == expected.visited_backward(i));
+        }
+        REQUIRE(result.visited_size() == 0);
+        REQUIRE(result.path_size() == expected.path_size());
+        for (std::size_t i = 0; i < result.path_size(); ++i)
+            REQUIRE(result.path(i) == expected.path(i));
+        REQUIRE(result.stats().path_cost == expected.stats().path_cost);
+
+        // The sink is removed again.
+        REQUIRE(maze.bfs().visited_size() != 0);
+    }
+
+    SECTION("Cancelled searches stop and leave the maze usable") {
+        auto maze = Maze(false, 600, 600);
+        maze.set_start(0, 0);
+        maze.set_end(599, 599);
+
+        // Both are cancelled once the first cells arrived, usually in the middle of the search.
+        SearchWorker worker;
+        for (auto const& search : {SearchWorker::Search([](Maze& m) { return m.dijkstra(); }),
+                                   SearchWorker::Search([](Maze& m) { return m.d_star_lite(); })}) {
+            worker.start(maze, search);
+            while (worker.drain([](int, bool) {}) == 0)
+                std::this_thread::yield();
+            worker.cancel();
+            REQUIRE(!worker.busy());
+        }
+
+        // D* Lite continues from the state the cancelled search left.
+        REQUIRE(maze.d_star_lite().stats().path_cost == maze.bfs().stats().path_cost);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Stepped search", "[stepped]") {
+    auto maze = Maze(true, 70, 50, 3, 9u);
+    maze.set_start(2, 3);
+    maze.set_end(65, 44);
+
+    SECTION("Visits the nodes in the order of the search on the maze") {
+        using Algorithm = SteppedSearch::Algorithm;
+        std::vector<std::pair<SteppedSearch, SearchTrace>> cases;
+        cases.emplace_back(SteppedSearch(maze, Algorithm::Bfs), maze.bfs());
+        cases.emplace_back(SteppedSearch(maze, Algorithm::Dfs), maze.dfs());
+        cases.emplace_back(SteppedSearch(maze, Algorithm::Dijkstra), maze.dijkstra());
+        cases.emplace_back(SteppedSearch(maze, Algorithm::AStar, Heuristics::Manhattan), maze.a_star(Heuristics::Manhattan));
+        cases.emplace_back(SteppedSearch(maze, Algorithm::AStar, Heuristics::Euclidean), maze.a_star(Heuristics::Euclidean));
+
+        for (auto& [search, expected] : cases) {
+            REQUIRE(search.current() == -1);
+            std::vector<int> visited;
+            while (!search.done()) {
+                REQUIRE(search.step(7) <= 7);
+                visited.insert(visited.end(), search.closed().begin(), search.closed().end());
+                if (!search.closed().empty())
+                    REQUIRE(search.current() == search.closed().back());
+            }
+
+            REQUIRE(search.found());
+            REQUIRE(search.step() == 0);
+            REQUIRE(visited.size() == expected.visited_size());
+            for (std::size_t i = 0; i < visited.size(); ++i)
+                REQUIRE(visited[i] == expected.visited(i));
+            REQUIRE(search.stats().expanded == expected.stats().expanded);
+            REQUIRE(search.stats().path_cost == expected.stats().path_cost);
+
+            auto const path = search.path();
+            REQUIRE(path.size() == static_cast<std::size_t>(expected.stats().path_cost) + 1);
+            REQUIRE(path.front() == maze.get_start().id);
+            REQUIRE(path.back() == maze.get_end().id);
+        }
+    }
+
+    SECTION("Frontier between steps") {
+        SteppedSearch search(maze, SteppedSearch::Algorithm::AStar);
+        std::vector<bool> opened(static_cast<std::size_t>(maze.get_grid().size()));
+        std::vector<bool> closed(opened.size());
+        opened[static_cast<std::size_t>(maze.get_start().id)] = true;
+
+        while (!search.done()) {
+            search.step(5);
+            for (auto const idx : search.opened())
+                opened[static_cast<std::size_t>(idx)] = true;
+            for (auto const idx : search.closed())
+                closed[static_cast<std::size_t>(idx)] = true;
+
+            // The open set holds reached nodes that were not taken yet.
+            std::size_t count = 0;
+            search.for_each_frontier([&](int idx) {
+                REQUIRE(opened[static_cast<std::size_t>(idx)]);
+                REQUIRE(!closed[static_cast<std::size_t>(idx)]);
+                REQUIRE(search.distance(idx) != SearchWorkspace::infinity);
+                ++count;
+            });
+            REQUIRE(count == search.frontier_size());
+        }
+    }
+
+    SECTION("Unreachable end") {
+        maze.set_passable(64, 44, false);
+        maze.set_passable(66, 44, false);
+        maze.set_passable(65, 43, false);
+        maze.set_passable(65, 45, false);
+        maze.set_passable(64, 43, false);
+        maze.set_passable(66, 43, false);
+        maze.set_passable(64, 45, false);
+        maze.set_passable(66, 45, false);
+
+        SteppedSearch search(maze, SteppedSearch::Algorithm::Bfs);
+        while (!search.done())
+            search.step(100, std::chrono::milliseconds(1));
+        REQUIRE(!search.found());
+        REQUIRE(search.path().empty());
+        REQUIRE(search.stats().path_cost == -1);
+        REQUIRE(search.frontier_size() == 0);
+    }
+}